@@ -0,0 +1,66 @@
+/**
+ * @file   allocStats.h
+ * @brief  The allocation accounting of the instrumented builds.
+ * 
+ * Configure with `-Dallocstats=1` to count the heap allocations of every
+ * thread: `ALLOC_SCOPE` then logs the allocations made in a scope, and
+ * `ALLOC_BUDGET` also warns when there are more than allowed. A budget
+ * growing with the results is raised by `ALLOC_ALLOW` once they are known.
+ * All expand to nothing in the usual builds.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+/** @brief The heap operations made by a thread so far. */
+struct AllocCounters {
+    quint64 allocs;
+    quint64 frees;
+    /** @brief The bytes requested by `allocs`. */
+    quint64 bytes;
+};
+
+#ifdef ALLOC_STATS
+
+/** @brief Gets the heap operations made by the calling thread so far. */
+AllocCounters threadAllocCounters();
+
+/** 
+ * @class AllocScope
+ * @brief Logs the heap operations made by the calling thread during its lifetime.
+ * 
+ * @note The work handed to other threads (e.g. the index builders) is not counted.
+ */
+class AllocScope {
+public:
+    /**
+     * @param name   The name of the scope (a literal).
+     * @param budget The allocations allowed (0 for no limit).
+     */
+    explicit AllocScope(const char* name, quint64 budget = 0);
+    ~AllocScope();
+
+    /** @brief Allows more allocations to a scope with a budget (none to a scope without). */
+    void allow(quint64 allocs) { if (budget) budget += allocs; }
+
+private:
+    const char*     name;
+    quint64         budget;
+    AllocCounters   start;
+};
+
+#define ALLOC_SCOPE(name) AllocScope allocScope(name)
+#define ALLOC_BUDGET(name, budget) AllocScope allocScope(name, budget)
+#define ALLOC_ALLOW(allocs) allocScope.allow(allocs)
+
+#else
+
+#define ALLOC_SCOPE(name)
+#define ALLOC_BUDGET(name, budget)
+#define ALLOC_ALLOW(allocs)
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file   collationIndex.h
+ * @brief  The collation order of an ordered entry list.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "frontCodedList.h"
+
+/** 
+ * @class CollationIndex
+ * @brief Orders the entries of a list by binary sort keys, so that the
+ *        entries differing only by case or accents are kept together.
+ * 
+ * The sort key of a text is its code points, case folded and without their
+ * non-spacing marks (after canonical decomposition), in UTF-8: keys compare
+ * with `memcmp`, in code point order. The entries with the same key keep
+ * the order of the list.
+ * 
+ * The key of a text starts with the key of any of its prefixes, so the
+ * entries starting with a prefix are among the ones whose keys start with
+ * the key of the prefix (a contiguous range of the collation order).
+ */
+class CollationIndex {
+public:
+    explicit CollationIndex(const FrontCodedList& list);
+
+    /** @brief Gets the sort key of a text. */
+    static QByteArray sortKey(const QString& text);
+
+    /**
+     * @brief Finds the entries whose keys start with the key of `prefix`.
+     * 
+     * @param[out] begin, end The range of positions in the collation order.
+     */
+    void prefixRange(const QString& prefix, int& begin, int& end) const;
+    /** @brief Gets the index (in the list) of the entry at a position of the collation order. */
+    int entryAt(int pos) const { return order[pos]; }
+    int size() const { return count; }
+
+    /** @brief Gets the memory taken by the index in bytes. */
+    qint64 bytes() const;
+
+private:
+    friend class SharedIndex;
+
+    /** @brief The arrays of an index built in memory. */
+    struct Storage {
+        QByteArray      keys;
+        QVector<int>    keyOffset;
+        QVector<int>    order;
+    };
+
+    /** @brief Reads arrays kept alive by `owner` (see the members). */
+    CollationIndex(
+        const std::shared_ptr<const void>& owner,
+        const char* keys, const int* keyOffset, const int* order, int count
+    );
+
+    /** @brief Appends the sort key of a text to `keys`. */
+    static void appendKey(QByteArray& keys, const QString& text);
+    /** @brief Compares the key of an entry with the start of `key` (0 if the former starts with the latter). */
+    int comparePrefix(int idx, const QByteArray& key) const;
+
+    /** @brief Keeps the arrays below alive (a `Storage`, or a mapped `SharedIndex`). */
+    std::shared_ptr<const void> owner;
+    /** @brief The keys of all the entries, in the order of the list. */
+    const char*     keys;
+    /** @brief The offset of the key of each entry in `keys`, and the end of the last one. */
+    const int*      keyOffset;
+    /** @brief The indices of the entries in the collation order. */
+    const int*      order;
+    int             count;
+};
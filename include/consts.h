@@ -25,16 +25,95 @@
 #define projectName "EasySymbol"
 
 #define pairDelim ' '
-#define fileFilter "text file (*.txt)"
+/* The suffix of the compressed dictionaries (see `PackArchive`). */
+#define packArchiveSuffix "esz"
+#define fileFilter "dictionary (*.txt *.esz);;text file (*.txt);;compressed dictionary (*.esz)"
 
 #define builtinConfig ".dict"
 
+/* The directory scanned for symbol packs (`*.txt`, `*.esz`). */
+#define packDir "packs"
+#define personalPackName "personal"
+/* The directory (next to the packs) where their indexes are shared (see `SharedIndex`). */
+#define sharedIndexDir ".index"
+/* Command line option to keep running in the background (resident mode). */
+#define residentOption "--resident"
+/* Command line options of the query service (see `QueryService`). */
+#define serveOption "--serve"
+#define queryOption "--query"
+#define benchOption "--bench"
+/* Command line option replaying a keystroke trace offscreen (see `KeystrokeReplay`). */
+#define replayOption "--replay"
+
 #define undefinedKey "undefined"
+/* Hints starting with it are regular expressions (see `PatternQuery`). */
+#define regexPrefix '/'
 
 /* Unit: Millisecond */
 const int defaultDuration = 2000;
 const int scrollInDuration = 300;
 const int scrollOutDuration = 300;
+/* Delay to coalesce the change notifications of a watched dictionary. */
+const int reloadDelay = 300;
+/* Time a frame may spend on filling search results. */
+const int frameBudget = 8;
+/* Time to wait for the running instance when launched again. */
+const int connectTimeout = 500;
+
+/* Heap allocations allowed on the hot paths (see `ALLOC_BUDGET`): to the query of an engine, */
+const int queryAllocBudget = 64;
+/* to each result it fetches, */
+const int resultAllocBudget = 8;
+/* and to each row shown in the table (its items, its glyphs queued). */
+const int rowAllocBudget = 16;
+
+/* Number of search results appended to the table at a time. */
+const int fillChunk = 64;
+/* Least size (in KB) of the pixmap cache holding the rendered targets (see `GlyphDelegate`). */
+const int glyphCacheKB = 16 << 10;
+/* Most targets rendered ahead of being shown, per query. */
+const int maxWarmGlyphs = 1024;
+
+/* Queries cheaper than this (in millisecond) are run without debouncing. */
+const int cheapQueryCost = 4;
+/* Upper bound of the debouncing delay for expensive queries. */
+const int maxDebounce = 150;
+
+/* Default memory cap (in bytes) of the query cache of each engine. */
+const qint64 defaultCacheBytes = 4 << 20;
+/* Likely next characters whose queries are run ahead in idle time (see `SearchEngine::prefetch`). */
+const int prefetchBranches = 3;
+/* Entries of the prefix range sampled to find them (evenly spaced in larger ranges). */
+const int prefetchSamples = 1024;
+
+/* Longest wait (in millisecond) for the table to show a replayed keystroke. */
+const int replayTimeout = 10000;
+
+/* Text (in bytes) compressed at a time in the dictionary archives (see `PackArchive`). */
+const int packChunkBytes = 256 << 10;
+/* zlib level of the archives: only the export pays for it. */
+const int packCompressionLevel = 9;
+
+/* Entries of a front coded block (see `FrontCodedList`). */
+const int frontCodingBlock = 16;
+/* Bits of the gram filter of each front coded block (see `GramFilter`). */
+const int gramFilterBits = 512;
+/* Entries from which the queries use postings (see `NgramIndex`, `TokenIndex`). */
+const int postingMinEntries = 4096;
+/* Most tokens a query term may match and still narrow the candidates. */
+const int maxUnionProbes = 16;
+
+/* Largest request frame (in bytes) accepted by the query service. */
+const int maxRequestFrame = 1 << 16;
+/* Largest reply frame (in bytes) accepted by the query clients. */
+const int maxReplyFrame = 64 << 20;
+/* Most queries in a batch, and most results of a query. */
+const int maxBatchQueries = 256;
+const int maxQueryResults = 4096;
+/* A client is not read any more while it has this many batches in flight, */
+const int maxClientBatches = 8;
+/* or this many reply bytes not sent yet. */
+const qint64 maxClientBacklog = 1 << 20;
 
 const int popupHeight = 40;
 
@@ -0,0 +1,47 @@
+/**
+ * @file   dictParser.h
+ * @brief  The single pass scanner of UTF-8 dictionaries.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QVector>
+
+#include "consts.h"
+
+/** @brief A line of a dictionary, in UTF-16 code units of the decoded text. */
+struct LineSpan {
+    int begin;
+    /** @brief The first `pairDelim` of the line (-1 if none). */
+    int delim;
+    /** @brief The end of the line (its '\n' excluded). */
+    int end;
+};
+
+/** 
+ * @class DictParser
+ * @brief Validates a UTF-8 dictionary and finds its lines & delimiters
+ *        in one pass over the bytes.
+ * 
+ * The bytes are examined 16 at a time with SSE2 where available: blocks of
+ * ASCII are validated by a single test, and the newlines & delimiters are
+ * found by comparing whole blocks. The positions are converted to UTF-16
+ * offsets on the fly, so they index `QString::fromUtf8` of the same bytes.
+ */
+class DictParser {
+public:
+    /**
+     * @brief Scans the bytes of a dictionary (after its BOM, see `skipBom`).
+     * 
+     * @param data       The bytes.
+     * @param size       The number of bytes.
+     * @param[out] lines The lines (untrimmed, maybe empty).
+     * @return FALSE if the bytes are not valid UTF-8.
+     */
+    static bool scan(const char* data, int size, QVector<LineSpan>& lines);
+    /** @brief Gets the length of the UTF-8 byte order mark `data` starts with (0 if none). */
+    static int skipBom(const char* data, int size);
+};
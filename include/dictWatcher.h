@@ -0,0 +1,104 @@
+/**
+ * @file   dictWatcher.h
+ * @brief  Watches imported dictionaries and reloads them incrementally.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+
+#include "consts.h"
+
+/** 
+ * @class DictWatcher
+ * @brief Keeps the dictionaries imported from disk in sync with the files.
+ * 
+ * Every watched file keeps a snapshot of the lines last seen in it.
+ * When the file changes, it is re-read and diffed against the snapshot
+ * on a worker thread, and only the added / removed lines are reported
+ * through `sourceChanged`, which is delivered in the GUI thread.
+ */
+class DictWatcher : public QObject {
+    Q_OBJECT
+public:
+    DictWatcher(QObject* parent = nullptr);
+    ~DictWatcher();
+
+    /**
+     * @brief Starts watching a dictionary file.
+     * 
+     * The current content of the file is taken as the baseline
+     * (it is assumed to be imported already), so no diff is reported for it.
+     * 
+     * @param filename The name of the text file.
+     */
+    void watch(const QString& filename);
+    /**
+     * @brief Starts watching a dictionary file imported in an earlier run.
+     * 
+     * The file is diffed against the lines imported then, so the changes
+     * made meanwhile are reported through `sourceChanged`.
+     * 
+     * @param filename The name of the text file.
+     * @param baseline The lines last seen in it (see `linesOf`).
+     */
+    void watch(const QString& filename, const QStringList& baseline);
+    /** @brief Stops watching a dictionary file. */
+    void unwatch(const QString& filename);
+
+    /** @brief Gets the names of all the watched files. */
+    QStringList sources() const { return snapshots.keys(); }
+    /** @brief Gets the lines last seen in a watched file (to be passed to `watch` later). */
+    QStringList linesOf(const QString& filename) const { return snapshots.value(filename).values(); }
+
+    /**
+     * @brief Checks if a line is still provided by another watched file.
+     * 
+     * @param line   The dictionary line.
+     * @param except The file to be ignored.
+     */
+    bool providedElsewhere(const QString& line, const QString& except) const;
+
+signals:
+    /**
+     * @brief Emitted when a watched file has been reloaded.
+     * 
+     * @param filename The name of the changed file.
+     * @param added    The lines which are new in the file.
+     * @param removed  The lines which no longer exist in the file.
+     */
+    void sourceChanged(
+        const QString& filename,
+        const QStringList& added,
+        const QStringList& removed
+    );
+
+private slots:
+    void on_file_changed(const QString& path);
+    void reload_dirty();
+
+private:
+    /**
+     * @brief Reloads & diffs a file on a worker thread.
+     * 
+     * @param filename The name of the file.
+     * @param report   Emits `sourceChanged` or only updates the baseline.
+     */
+    void startReload(const QString& filename, bool report);
+
+    QFileSystemWatcher* fsWatcher;
+    /** @brief Debounces bursts of change notifications. */
+    QTimer*             delayTimer;
+
+    /** @brief Lines last seen in every watched file. */
+    QHash<QString, QSet<QString>> snapshots;
+    /** @brief Files changed but not reloaded yet. */
+    QSet<QString> dirty;
+    /** @brief Files being reloaded now. */
+    QSet<QString> running;
+};
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <QtCore/QSet>
+
 #include "consts.h"
 #include "logger.h"
 
@@ -17,7 +19,7 @@ public:
     ~FileHandler();
 
     void resetReadPtr() { index = 0; }
-    void clearCache() { resetReadPtr(); lines.clear(); }
+    void clearCache() { resetReadPtr(); lines.clear(); delims.clear(); lineSet.clear(); }
 
     /**
      * @brief Loads a text file (`*.txt`) as the dictionary.
@@ -32,6 +34,11 @@ public:
      * ```
      * where `delim` is defined in `consts.h`.
      * 
+     * UTF-8 files are scanned in one pass (see `DictParser`),
+     * others are decoded by the codec of the locale. Compressed
+     * dictionaries (see `PackArchive`) are decompressed & parsed
+     * in parallel, a chunk per task.
+     * 
      * @param filename The name of the text file.
      * @return If the operation is successful or not.
      * 
@@ -42,15 +49,76 @@ public:
     /**
      * @brief Loads dictionary directly from a string.
      * 
+     * The lines already in the buffer are skipped as they stream in,
+     * so the cost only depends on the size of `rawString`.
+     * 
      * @param rawString The string representing dictionary.
      * 
      * @see loadFromText
      */
     void loadFromString(const QString& rawString);
 
+    /**
+     * @brief Reads the whole content of a text file (or of a compressed dictionary).
+     * 
+     * @param filename      The name of the text file.
+     * @param[out] contents The content of the file.
+     * @return If the operation is successful or not.
+     * 
+     * @note It touches no member, so it is safe to call from a worker thread.
+     */
+    static bool readText(const QString& filename, QString& contents);
+
+    /**
+     * @brief Splits UTF-8 dictionary text into trimmed, non-empty lines.
+     * 
+     * @param data        The bytes (after the BOM, see `DictParser::skipBom`).
+     * @param size        The number of bytes.
+     * @param[out] lines  The lines appended, duplicates included.
+     * @param[out] delims The first `pairDelim` of each line (-1 if none).
+     * @return FALSE if the bytes are not valid UTF-8.
+     * 
+     * @note It touches no member, so it is safe to call from a worker thread.
+     */
+    static bool parseUtf8(const char* data, int size, QStringList& lines, QVector<int>& delims);
+
+    /**
+     * @brief Splits a raw dictionary string into trimmed, non-empty and unique lines.
+     * 
+     * @param rawString The string representing dictionary.
+     * @return The lines in the order they first occur.
+     */
+    static QStringList splitLines(const QString& rawString);
+
+    /**
+     * @brief Splits a dictionary line into a pair of words.
+     * 
+     * @param line       A line of the dictionary (see `loadFromText`).
+     * @param[out] key   The hint part of the line.
+     * @param[out] value The target part of the line.
+     * @return FALSE if the line has no key (`key` is set to `undefinedKey`).
+     */
+    static bool parseLine(const QString& line, QString& key, QString& value);
+
+    /**
+     * @brief Appends a single line to the line buffer.
+     * 
+     * @return FALSE if the line is empty or already in the buffer.
+     */
+    bool addLine(const QString& line);
+    /**
+     * @brief Removes lines from the line buffer (compacted once, in linear time).
+     * 
+     * @param toRemove The lines to remove.
+     * @return The (trimmed) lines found & removed from the buffer.
+     */
+    QStringList removeLines(const QStringList& toRemove);
+
     /** 
      * @brief Saves current line buffer (`lines`) to a text file.
      * 
+     * The file is compressed (see `PackArchive`) if its suffix is `packArchiveSuffix`.
+     * 
      * @param filename The target file name.
      * @return If the retrieve operation successful or not.
      */
@@ -65,12 +133,38 @@ public:
      *         If the end of the `rawFile` is reached, it will return FALSE.
      */
     bool getWordPair(QString& key, QString& value);
+    /**
+     * @brief Retrieves the remaining words as the entries of a search engine.
+     * 
+     * Same as `<key><delim><value>` of every `getWordPair`, but each entry
+     * is built in one allocation from the delimiter found while loading.
+     * 
+     * @param[out] entries The vector where the entries are appended.
+     */
+    void takeEntries(QVector<QString>& entries);
 
     // TODO: bool addWordPair(const QString& key, const QString& value);
 
 private:
+    /**
+     * @brief Loads the lines of a compressed dictionary (all or none of them).
+     * 
+     * @return FALSE if the archive is corrupted.
+     */
+    bool loadArchive(const QByteArray& archive);
+    /**
+     * @brief Appends a trimmed line if it is not in the buffer yet.
+     * 
+     * @return FALSE if the line is a duplicate.
+     */
+    bool insertLine(const QString& trimmed, int delim);
+
     /** @brief Buffer line of the file. */
     QStringList lines;
+    /** @brief The first `pairDelim` of each line in `lines` (-1 if none). */
+    QVector<int> delims;
+    /** @brief The lines in `lines`, to reject duplicates in O(1) (shares their data). */
+    QSet<QString> lineSet;
     /** @brief Current index of the line. */
     int         index;
 };
@@ -0,0 +1,240 @@
+/**
+ * @file   frontCodedList.h
+ * @brief  Compressed storage of an ordered string list.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "consts.h"
+
+/** 
+ * @class GramFilter
+ * @brief A Bloom filter of the code units & pairs of code units (bigrams)
+ *        of some strings.
+ * 
+ * A string holding a substring holds all its code units & bigrams, so
+ * the substring is not in any of the strings when the filter misses one.
+ */
+class GramFilter {
+public:
+    /** @brief Constructs an empty filter. */
+    GramFilter();
+
+    /** @brief Adds the code units & bigrams of a string. */
+    void add(const QChar* chars, int len);
+    void add(const QString& str) { add(str.constData(), str.size()); }
+    /** @brief Check if it holds all the grams of `other` (or may be holding them). */
+    bool covers(const GramFilter& other) const;
+
+private:
+    void set(quint32 gram);
+
+    quint64 bits[gramFilterBits / 64];
+};
+
+/** 
+ * @class FrontCodedList
+ * @brief An immutable ordered list of unique strings, front coded in blocks.
+ * 
+ * Entries are grouped in blocks of `frontCodingBlock` to `2 * frontCodingBlock`
+ * entries, and split into a key (up to the first `pairDelim`) and a tail (the
+ * rest). The first key of a block is stored in full, and every other one as
+ * the length of the prefix it shares with the previous key followed by the
+ * rest of it; tails are stored in full. All the blocks share one buffer of
+ * UTF-16 code units, with a sparse index holding the offset & first entry
+ * number of each block. The arrays are immutable, and shared by the copies
+ * (they may also be mapped from a `SharedIndex`).
+ * 
+ * The keys of a block are stored as Latin-1 bytes (two per code unit) when
+ * none of them needs more, which halves them in the usual dictionaries.
+ * 
+ * Lookups binary search the first entries of the blocks in place, then scan
+ * a single block; sequential scans (`Reader`) decode one entry at a time.
+ * Substring scans skip the blocks whose `GramFilter` rules the substring out
+ * (the first entries of the blocks already bound their keys for prefixes).
+ * 
+ * @note The order is the one of `QString::operator<` (UTF-16 code units).
+ */
+class FrontCodedList {
+public:
+    /** @brief Constructs an empty list. */
+    FrontCodedList();
+    /** @param sorted Ordered entries without duplicates. */
+    explicit FrontCodedList(const QVector<QString>& sorted);
+
+    /** 
+     * @class Reader
+     * @brief Decodes the entries from a position onwards.
+     * 
+     * @note It reads the list it is created on, which must outlive it.
+     */
+    class Reader {
+    public:
+        Reader();
+        Reader(const FrontCodedList* list, int idx);
+
+        /** @brief Moves to an entry (anywhere in the list). */
+        void seek(int idx);
+        /** @brief Moves to the next entry. */
+        void next();
+        bool atEnd() const { return list == nullptr || idx >= list->count; }
+        /** @brief Gets the index of the current entry. */
+        int index() const { return idx; }
+        /** @brief Gets the current entry (valid until the reader moves). */
+        const QString& value() const;
+
+        /** @brief Check if the key of the current entry is in `latin1Key` (or else `wideKey`). */
+        bool isLatin1() const { return latin1; }
+        /** @brief Gets the key of the current entry, if `isLatin1`. */
+        const QByteArray& latin1Key() const { return key8; }
+        /** @brief Gets the key of the current entry, unless `isLatin1`. */
+        const QString& wideKey() const { return key16; }
+        /** @brief Gets the current entry after its key (from the `pairDelim` on). */
+        const QString& tail() const { return rest; }
+
+    private:
+        /** @brief Decodes the first entry of a block. */
+        void startBlock(int block);
+        /** @brief Decodes the rest of a key, then the tail of the entry. */
+        void readEntry(const ushort* p, int keyLen);
+
+        const FrontCodedList* list;
+        int             idx;
+        int             block;
+        /** @brief The position of the next entry in `list->units`. */
+        int             offset;
+        /** @brief If the keys of `block` are Latin-1. */
+        bool            latin1;
+        QByteArray      key8;
+        QString         key16;
+        QString         rest;
+        /** @brief The whole entry, joined by `value` when `stale`. */
+        mutable QString cur;
+        mutable bool    stale;
+    };
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    /** @brief Decodes an entry (logarithmic). */
+    QString at(int idx) const;
+    /** @brief Decodes all the entries. */
+    QVector<QString> toList() const;
+
+    /** @brief Gets the index of the first entry not less than `key`. */
+    int lowerBound(const QString& key) const;
+    /** @brief Gets the index of the first entry from `from` not starting with `prefix`. */
+    int prefixEnd(const QString& prefix, int from) const;
+
+    /**
+     * @brief Skips the blocks which cannot hold the grams of `filter`.
+     * 
+     * @param filter   The grams (of the substrings looked for).
+     * @param from     The first entry examined.
+     * @param[out] end The end of the block of the result.
+     * @return The first entry from `from` in a block which may hold the grams,
+     *         or `size()` if there is none.
+     */
+    int skipBlocks(const GramFilter& filter, int from, int& end) const;
+
+    /** @brief Gets a copy with `key` inserted at `idx` (only one block is re-encoded). */
+    FrontCodedList inserted(int idx, const QString& key) const;
+    /** @brief Gets a copy without the entry at `idx` (only one block is re-encoded). */
+    FrontCodedList removed(int idx) const;
+    /**
+     * @brief Gets a copy with ordered changes applied.
+     * 
+     * Only the blocks where entries are added or removed are re-encoded:
+     * the others are moved as they are.
+     * 
+     * @param added   Ordered entries without duplicates (added once).
+     * @param removed Ordered entries without duplicates (ignored if absent).
+     */
+    FrontCodedList merged(const QVector<QString>& added, const QVector<QString>& removed) const;
+
+    /** @brief Gets the memory taken by the list in bytes. */
+    qint64 bytes() const;
+
+private:
+    friend class SharedIndex;
+
+    /** @brief The arrays of a list built in memory. */
+    struct Storage {
+        Storage();
+
+        QVector<ushort>     units;
+        QVector<int>        blockOffset;
+        QVector<int>        blockStart;
+        QVector<quint8>     blockLatin1;
+        QVector<GramFilter> blockFilter;
+        int                 count;
+    };
+
+    /** @brief Reads the arrays of `storage`. */
+    explicit FrontCodedList(const std::shared_ptr<Storage>& storage);
+    /** @brief Reads arrays kept alive by `owner` (see the members). */
+    FrontCodedList(
+        const std::shared_ptr<const void>& owner, const ushort* units,
+        const int* blockOffset, const int* blockStart, const quint8* blockLatin1,
+        const GramFilter* blockFilter, int blocks, int count
+    );
+    /**
+     * @brief Check if every block decodes within its units (for arrays read from a file).
+     * 
+     * @note The block arrays themselves must be in bounds already.
+     */
+    bool isWellFormed() const;
+
+    /** @brief Gets the block holding an entry. */
+    int blockOf(int idx) const;
+    /** @brief Gets the last block whose first entry is not greater than `key` (0 if none). */
+    int blockFor(const QString& key) const;
+    /** @brief Gets the end (exclusive) of the entries of a block. */
+    int blockEnd(int block) const { return block + 1 < blocks ? blockStart[block + 1] : count; }
+    /**
+     * @brief Compares the first entry of a block with `key` (in place).
+     * 
+     * @param prefix If only the first `key.size()` code units of the entry count.
+     */
+    int compareHead(int block, const QString& key, bool prefix) const;
+    /** @brief Decodes the entries of a block. */
+    QVector<QString> decodeBlock(int block) const;
+    /** @brief Encodes ordered entries in blocks of `frontCodingBlock`. */
+    static std::shared_ptr<Storage> encode(const QVector<QString>& sorted);
+    /** @brief Encodes ordered entries as blocks of `blockSize`, appended to `storage`. */
+    static void appendBlocks(
+        Storage& storage, const QString* first, const QString* last, int blockSize
+    );
+    /** @brief Appends the blocks from `first` to `last` (exclusive) as they are to `storage`. */
+    void copyBlocks(Storage& storage, int first, int last) const;
+    /**
+     * @brief Gets a copy where the entries of a block are replaced.
+     * 
+     * @param block   The block replaced.
+     * @param entries Its new entries (maybe empty).
+     */
+    FrontCodedList replacedBlock(int block, const QVector<QString>& entries) const;
+
+    /** @brief Keeps the arrays below alive (a `Storage`, or a mapped `SharedIndex`). */
+    std::shared_ptr<const void> owner;
+    /** @brief The encoded blocks. */
+    const ushort*   units;
+    /** @brief The offset of each block in `units`, and the end of the last one. */
+    const int*      blockOffset;
+    /** @brief The index of the first entry of each block. */
+    const int*      blockStart;
+    /** @brief If the keys of each block are stored as Latin-1 bytes. */
+    const quint8*   blockLatin1;
+    /** @brief The grams of the entries of each block. */
+    const GramFilter* blockFilter;
+    int             blocks;
+    int             count;
+};
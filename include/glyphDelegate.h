@@ -0,0 +1,52 @@
+/**
+ * @file   glyphDelegate.h
+ * @brief  The delegate drawing the target column from cached pixmaps.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QQueue>
+#include <QtWidgets/QAbstractItemView>
+#include <QtWidgets/QStyledItemDelegate>
+
+#include "consts.h"
+
+/** 
+ * @class GlyphDelegate
+ * @brief Draws the targets (mostly emoji and rare symbols) as cached pixmaps.
+ * 
+ * Shaping those through font fallback is slow, so each target is rendered
+ * once per (text, font, color, device pixel ratio) into `QPixmapCache`,
+ * and then only blitted. Targets too wide for their cell are drawn
+ * (elided) by `QStyledItemDelegate`.
+ */
+class GlyphDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    /** @param view The view the delegate draws (its font & palette are used to warm the cache). */
+    explicit GlyphDelegate(QAbstractItemView* view);
+
+    void paint(
+        QPainter* painter, const QStyleOptionViewItem& option,
+        const QModelIndex& index
+    ) const override;
+
+    /** @brief Renders targets in idle time, before they are shown. */
+    void warm(const QStringList& texts);
+    /** @brief Drops the targets not rendered yet (their query is abandoned). */
+    void cancelWarming();
+
+private slots:
+    void warm_next();
+
+private:
+    /** @brief Gets the pixmap of a target (rendered on a miss). */
+    static QPixmap glyphs(const QString& text, const QFont& font, const QColor& color, qreal dpr);
+
+    QAbstractItemView* view;
+    QQueue<QString> pending;
+    QTimer* warmTimer;
+};
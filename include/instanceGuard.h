@@ -0,0 +1,64 @@
+/**
+ * @file   instanceGuard.h
+ * @brief  Keeps a single resident instance of the program per user.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#include "consts.h"
+
+/** 
+ * @class InstanceGuard
+ * @brief Detects the running instance over a local socket.
+ * 
+ * The resident instance listens on `serverName()`. A later launch connects
+ * to it, hands over its arguments and quits, while the resident instance
+ * receives them through `activated` (in the GUI thread).
+ */
+class InstanceGuard : public QObject {
+    Q_OBJECT
+public:
+    InstanceGuard(QObject* parent = nullptr);
+    ~InstanceGuard();
+
+    /** @brief Gets the name of the local server (unique per user). */
+    static QString serverName();
+
+    /**
+     * @brief Hands the arguments over to the running instance, if any.
+     * 
+     * @param args The command line arguments.
+     * @return If an instance is running and received the arguments.
+     */
+    static bool notifyRunning(const QStringList& args);
+    /**
+     * @brief Becomes the running instance.
+     * 
+     * @return If the local server is listening.
+     */
+    bool listen();
+    /** @brief Stops being the running instance. */
+    void close();
+    /** @brief If it is the running instance. */
+    bool isListening() const;
+
+signals:
+    /** @brief Emitted when another launch handed its arguments over. */
+    void activated(const QStringList& args);
+
+private slots:
+    void on_new_connection();
+    void read_arguments();
+
+private:
+    /** @brief Reads the arguments sent by another launch, once complete. */
+    void readArguments(QLocalSocket* socket);
+
+    QLocalServer*   server;
+};
@@ -0,0 +1,84 @@
+/**
+ * @file   keystrokeReplay.h
+ * @brief  Replays recorded keystrokes on an offscreen window and reports
+ *         how long the table takes to show their results.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTextStream>
+
+#include "consts.h"
+#include "mainWindow.h"
+
+/** 
+ * @class KeystrokeReplay
+ * @brief Sends the events of a trace to the hint editor one by one, and
+ *        measures the latency from each event to the table showing its
+ *        first screen / all of its results.
+ * 
+ * A trace holds one event per line (`#` starts a comment):
+ *   - `type <text>`: one key press per character;
+ *   - `backspace [count]`: presses Backspace (once by default);
+ *   - `paste <text>`: inserts the text at once;
+ *   - `clear`: clears the hint;
+ *   - `wait <msecs>`: lets the event loop run idle.
+ * 
+ * The report is a tab-separated line per event followed by a summary,
+ * stable enough to be compared between builds.
+ */
+class KeystrokeReplay : public QObject {
+    Q_OBJECT
+public:
+    /** @brief An event of a trace. */
+    struct Event {
+        enum Kind { Type, Backspace, Paste, Clear, Wait };
+        Kind    kind;
+        /** @brief The character typed, the text pasted, or the idle time (`Wait`). */
+        QString text;
+    };
+
+    explicit KeystrokeReplay(mainWindow* win, QObject* parent = nullptr);
+
+    /**
+     * @brief Parses a trace.
+     * 
+     * @param contents    The trace.
+     * @param[out] events The events (one per keystroke).
+     * @param[out] error  The reason of the failure.
+     * @return If the trace is valid.
+     */
+    static bool parse(const QString& contents, QVector<Event>& events, QString& error);
+
+    /** @brief Replays the events, and writes the report to `out`. */
+    void replay(const QVector<Event>& events, QTextStream& out);
+
+    /**
+     * @brief Runs `--replay <trace> <dictionary>`: replays the trace on an
+     *        offscreen scratch window searching the dictionary only.
+     * 
+     * @param args The command line arguments.
+     * @return The exit code.
+     */
+    static int run(const QStringList& args);
+
+private slots:
+    void table_updated(const QString& hint, bool complete);
+
+private:
+    /** @brief Delivers an event to the hint editor. */
+    void send(const Event& event);
+
+    mainWindow*     win;
+    /** @brief Runs until the table is complete, or `deadline` expires. */
+    QEventLoop      loop;
+    QTimer*         deadline;
+    QElapsedTimer   timer;
+    /** @brief When the first screen / all the results of the last event were shown (ns). */
+    qint64          shownAt, filledAt;
+};
@@ -1,20 +1,61 @@
 #pragma once
 
 #include "consts.h"
+#include "dictWatcher.h"
 #include "fileHandler.h"
+#include "glyphDelegate.h"
+#include "packManager.h"
 #include "searchEngine.h"
 #include "logger.h"
 #include "popup.h"
+#include "queryScheduler.h"
 
 #include "helpDialog.h"
+#include "instanceGuard.h"
+#include "queryService.h"
 
 #include "ui_mainWindow.h"
 
 class mainWindow : public QMainWindow, public Ui::mainWindow {
     Q_OBJECT
 public:
-    mainWindow(QWidget* parent = 0);
+    /**
+     * @param dictionary The personal dictionary. With another one than
+     *                   `builtinConfig`, it is a scratch window (see `KeystrokeReplay`):
+     *                   the settings and the packs are neither loaded nor saved.
+     */
+    mainWindow(QWidget* parent = 0, const QString& dictionary = builtinConfig);
     ~mainWindow();
+
+    /**
+     * @brief Switches the resident mode.
+     * 
+     * A resident window is hidden instead of closed after copying,
+     * and is re-shown when the program is launched again.
+     */
+    void setResident(bool on);
+    /** @brief Switches the query service for the other local programs. */
+    void setServing(bool on);
+    /** @brief Check if all the enabled packs are ready to be queried. */
+    bool isIndexed() const { return packs->isIndexed(); }
+
+signals:
+    /**
+     * @brief Emitted when the table shows the results of a hint.
+     * 
+     * @param hint     The hint of the results (not always the one being edited).
+     * @param complete If all the results are shown (else only the first screen).
+     */
+    void tableUpdated(const QString& hint, bool complete);
+
+public slots:
+    /**
+     * @brief Shows the window and imports the dictionaries given.
+     * 
+     * @param args The command line arguments (of this or a later launch).
+     */
+    void activate_instance(const QStringList& args);
+
 private:
     void initAppearance();
     void loadStyleSheet();
@@ -22,12 +63,22 @@ private:
 
     void loadSettings();
     void writeSettings();
+    void createPackActions();
+    /** @brief Loads a pack, and refreshes the results once it is read in the background. */
+    void loadPack(int idx);
+    /** @brief Refreshes the results once a background load or merge is published. */
+    void refreshWhenDone(const QFuture<void>& future);
 
     bool load(const QString& filename);
     bool save(const QString& filename);
 
     void updateTable();
+    void appendTableRows(const strQueue& rows);
     void clearTableContentItems();
+    /** @brief Number of table rows fitting in the view. */
+    int visibleRowCount() const;
+    /** @brief Heap allocations allowed to a query of the table, besides its rows (see `ALLOC_BUDGET`). */
+    quint64 allocBudget(const QString& pattern) const;
 
     void initAnimation();
 
@@ -35,9 +86,35 @@ private:
 
     helpDialog* hDialog;
     Popup* popup;
+    PackManager* packs;
+    /** @brief The index of the personal dictionary (`builtinConfig`) in `packs`. */
+    int personalPack;
+    /** @brief Handler & engine of the personal dictionary. */
     FileHandler* fHandler;
+    DictWatcher* dictWatcher;
     SearchEngine* searchEngine;
 
+    QueryScheduler* scheduler;
+
+    InstanceGuard* instanceGuard;
+    bool resident;
+    /** @brief If nothing is saved (nor loaded from the settings). */
+    bool scratch;
+    QueryService* queryService;
+
+    /** @brief The results of the current hint not shown yet. */
+    PackCursor searchCursor;
+    /** @brief The hint of `searchCursor` (the editor may hold a newer one). */
+    QString cursorHint;
+    /** @brief Fills the remaining results in later event loop iterations. */
+    QTimer* fillTimer;
+    /** @brief Draws the targets from cached pixmaps. */
+    GlyphDelegate* glyphDelegate;
+    /** @brief Number of result rows in the table. */
+    int filledRows;
+    /** @brief Time spent on the current hint so far (ms). */
+    qint64 queryCost;
+
     QPropertyAnimation* animeIn;
     QPropertyAnimation* animeOut;
 
@@ -46,12 +123,25 @@ private:
 private slots:
 
     void on_hintEdit_textChanged(const QString& text);
+    void run_query(const QString& pattern);
+    void fill_table();
+    void toggle_pack(QAction* action);
+    void preload_packs();
+    void entries_published();
+    void toggle_resident(bool on);
+    void toggle_serving(bool on);
+    void hide_window();
     void on_targetTable_itemClicked(QTableWidgetItem* item);
     void on_targetTable_itemDoubleClicked(QTableWidgetItem* item);
 
     /* Common Actions */
     void import_dict();
     void export_dict();
+    void reload_dict(
+        const QString& filename,
+        const QStringList& added,
+        const QStringList& removed
+    );
     void help();
     void aboutAuthor();
 };
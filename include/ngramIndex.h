@@ -0,0 +1,46 @@
+/**
+ * @file   ngramIndex.h
+ * @brief  The n-gram postings of an ordered entry list.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+
+#include "consts.h"
+#include "frontCodedList.h"
+#include "postings.h"
+
+/** 
+ * @class NgramIndex
+ * @brief Maps every trigram (3 UTF-16 code units) to the ordered indices of
+ *        the entries containing it.
+ * 
+ * An entry containing a literal contains all the trigrams of the literal,
+ * so intersecting their postings gives the candidates for it.
+ */
+class NgramIndex {
+public:
+    /** @brief The length of the n-grams. */
+    static constexpr int gram = 3;
+
+    explicit NgramIndex(const FrontCodedList& list);
+
+    /**
+     * @brief Finds the entries which may contain all the literals.
+     * 
+     * @param literals       The literals.
+     * @param[out] candidates The ordered indices of the candidates.
+     * @return FALSE if no literal is long enough to narrow the entries.
+     */
+    bool candidates(const QStringList& literals, QVector<int>& candidates) const;
+
+private:
+    static quint64 keyOf(const QChar* chars);
+
+    QHash<quint64, QVector<int>> postings;
+};
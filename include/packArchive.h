@@ -0,0 +1,75 @@
+/**
+ * @file   packArchive.h
+ * @brief  The compressed format of the dictionaries (symbol packs).
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "consts.h"
+
+/** @brief A compressed chunk of an archive. */
+struct PackChunk {
+    /** @brief The position of its data in the archive. */
+    int offset;
+    int packedSize;
+    /** @brief The size of its text once decompressed. */
+    int rawSize;
+};
+
+/**
+ * @class PackArchive
+ * @brief Compresses the lines of a dictionary into independent chunks.
+ * 
+ * The UTF-8 text of the dictionary is cut at line boundaries into chunks
+ * of about `packChunkBytes`, each compressed by zlib (`qCompress`) on its
+ * own. A table of the chunks follows the magic, so the readers may
+ * decompress & parse all of them at once, on as many cores.
+ * 
+ * The archives are told apart from the text files by their magic,
+ * whatever their file name is.
+ */
+class PackArchive {
+public:
+    /** @brief Checks if bytes (at least the start of a file) are an archive. */
+    static bool isArchive(const QByteArray& bytes);
+
+    /**
+     * @brief Compresses the lines of a dictionary (the chunks in parallel).
+     *
+     * @param lines The lines, without their '\n'.
+     * @return The archive.
+     */
+    static QByteArray pack(const QStringList& lines);
+
+    /**
+     * @brief Reads the table of the chunks of an archive.
+     *
+     * @param archive     The archive.
+     * @param[out] chunks The chunks, in the order of the text.
+     * @return FALSE if it is not a valid archive.
+     */
+    static bool index(const QByteArray& archive, QVector<PackChunk>& chunks);
+    /**
+     * @brief Decompresses a chunk.
+     *
+     * @return The UTF-8 text of the chunk (null if it is corrupted).
+     *
+     * @note It touches no shared state, so it is safe to call from a worker thread.
+     */
+    static QByteArray inflate(const QByteArray& archive, const PackChunk& chunk);
+    /**
+     * @brief Decompresses a whole archive.
+     *
+     * @param archive    The archive.
+     * @param[out] text  The UTF-8 text of the dictionary.
+     * @return FALSE if it is not a valid archive.
+     */
+    static bool unpack(const QByteArray& archive, QByteArray& text);
+};
@@ -0,0 +1,178 @@
+/**
+ * @file   packManager.h
+ * @brief  The named dictionaries (symbol packs) loaded on demand.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QFuture>
+#include <QtCore/QSet>
+
+#include "consts.h"
+#include "fileHandler.h"
+#include "searchEngine.h"
+
+/** @brief A named dictionary with its own search engine. */
+struct DictPack {
+    QString         name;
+    QString         filename;
+    /** @brief If it takes part in the queries. */
+    bool            enabled;
+    /** @brief If the file has been loaded into `handler` & `engine`. */
+    bool            loaded;
+    /** @brief If its ordered entries are mapped from (and published to) a `SharedIndex`. */
+    bool            shared;
+    /**
+     * @brief Reads a shared pack into `engine` in the background (see `ensureLoaded`).
+     *        Its result tells if the file could be read.
+     */
+    QFuture<bool>   loading;
+    FileHandler*    handler;
+    SearchEngine*   engine;
+};
+
+/**
+ * @class PackCursor
+ * @brief Resumable result stream of a query over several packs.
+ * 
+ * The prefix matches of all the packs come first, then the other matches.
+ * Each pass is merged in order, and the entries provided by
+ * more than one pack are yielded once.
+ * 
+ * @see SearchCursor
+ */
+class PackCursor {
+public:
+    /** @brief Constructs a cursor with no result. */
+    PackCursor();
+    /**
+     * @brief Starts a query over some engines.
+     * 
+     * @note The engines are only read, so it may run on any thread.
+     */
+    PackCursor(const QVector<const SearchEngine*>& engines, const QString& pattern);
+
+    /** @see SearchCursor::fetch */
+    int fetch(
+        strQueue& out, int maxCount,
+        QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever)
+    );
+    /** @brief Check if all the results have been retrieved. */
+    bool atEnd() const { return done; }
+
+private:
+    /** @brief Starts merging a pass (`SearchCursor::Pass`) of all the engines. */
+    void startPass(int pass);
+    /** @brief Updates the sort key of the head of a buffer, once it changed. */
+    void refreshHead(int idx);
+    /** @brief Check if the head of a buffer comes before another one in the current pass. */
+    bool precedes(int a, int b) const;
+
+    QVector<const SearchEngine*> engines;
+    QString                 pat;
+    int                     pass;
+    /** @brief One cursor (and its fetched results) per engine. */
+    QVector<SearchCursor>   cursors;
+    QVector<strQueue>       buffers;
+    /** @brief If the pass is merged in collation order (literal prefix pass), else in code units. */
+    bool                    collated;
+    /** @brief The sort key of the head of each buffer (`collated` only). */
+    QVector<QByteArray>     headKeys;
+    /** @brief If some engine yields the pass unordered (the duplicates are not adjacent). */
+    bool                    unordered;
+    /** @brief The results of the pass yielded so far (`unordered` only). */
+    QSet<QString>           yielded;
+    /** @brief The last result yielded. */
+    QString                 last;
+    bool                    done;
+};
+
+/**
+ * @class PackManager
+ * @brief Registers the packs, and loads them from disk the first time
+ *        a query needs them.
+ */
+class PackManager {
+public:
+    PackManager();
+    ~PackManager();
+
+    /**
+     * @brief Registers a pack without loading it.
+     * 
+     * @param name     The unique name of the pack.
+     * @param filename The dictionary file (see `FileHandler::loadFromText`).
+     * @param enabled  If it takes part in the queries.
+     * @param shared   If its index is shared by the processes (the file is read-only).
+     * @return The index of the pack.
+     */
+    int addPack(
+        const QString& name, const QString& filename, bool enabled, bool shared = false
+    );
+    /**
+     * @brief Registers every dictionary (text or compressed) in a directory as a disabled pack,
+     *        named after the base name of the file, with a shared index.
+     * 
+     * @return The number of packs registered.
+     */
+    int scan(const QString& dirname);
+
+    /** @brief Gets the number of packs. */
+    int count() const { return packs.size(); }
+    /** @brief Gets a pack by its index. */
+    const DictPack& pack(int idx) const { return packs[idx]; }
+    /** @brief Gets the index of a pack by its name (-1 if not found). */
+    int indexOf(const QString& name) const;
+    /** @brief Gets the names of the enabled packs. */
+    QStringList enabledNames() const;
+
+    /**
+     * @brief Enables / disables a pack.
+     * 
+     * @note A disabled pack is unloaded to release its memory.
+     */
+    void setEnabled(int idx, bool enabled);
+    /**
+     * @brief Loads a pack if it has not been loaded yet.
+     * 
+     * A shared pack is read, parsed & ordered on a worker (`loading`): its
+     * engine is empty until the entries are published. The personal pack
+     * backs the edits (`handler`), so it is read by the caller.
+     * A pack which failed to be read is read again by the next call.
+     * 
+     * @return If the pack is loaded (or being loaded).
+     */
+    bool ensureLoaded(int idx);
+
+    /**
+     * @brief Starts a query over all the enabled packs (loaded on demand).
+     * 
+     * @param pattern The specific pattern string.
+     */
+    PackCursor search(const QString& pattern);
+    /** @brief Gets the engines of all the enabled packs (loaded on demand). */
+    QVector<const SearchEngine*> enabledEngines();
+    /** @brief Check if all the enabled packs are loaded (not being or failed to be) & ordered. */
+    bool isIndexed() const;
+    /**
+     * @brief Warms the caches of the enabled packs with the likely next queries.
+     * 
+     * @see SearchEngine::prefetch
+     */
+    void prefetch(const QString& pattern);
+    /** @brief Stops warming the caches. */
+    void cancelPrefetch();
+
+    /** @brief Sets the memory cap of the query cache of every pack in bytes. */
+    void setCacheCapacity(qint64 capacity);
+    /** @brief Gets the query cache statistics summed over the packs. */
+    QueryCache::Stats cacheStats() const;
+
+private:
+    QVector<DictPack> packs;
+    /** @brief The memory cap of the query cache of each pack. */
+    qint64            cacheBytes;
+};
@@ -0,0 +1,64 @@
+/**
+ * @file   patternQuery.h
+ * @brief  The regex / glob queries.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QRegularExpression>
+#include <QtCore/QStringList>
+
+#include "consts.h"
+
+/** 
+ * @class PatternQuery
+ * @brief A hint compiled into an automaton (a regular expression).
+ * 
+ * A hint is a pattern query if it is:
+ *   - a regex, prefixed with `regexPrefix` (`/^heart.*`);
+ *   - a glob, with `*` (any run) or `?` (any character), e.g. `arrow*left`.
+ * Both match anywhere in an entry, like the plain queries,
+ * and the entries matching from their beginning come first.
+ * 
+ * Besides matching, it tells the search engine how to avoid most entries:
+ *   - `deadPrefix` finds a prefix of an entry the automaton anchored at
+ *     the beginning cannot get past, so all the entries sharing it are skipped;
+ *   - `requiredLiterals` are contained in every match, so only the entries
+ *     holding their n-grams are candidates (see `NgramIndex`).
+ */
+class PatternQuery {
+public:
+    /** @brief Check if a hint is a pattern query. */
+    static bool isPattern(const QString& hint);
+
+    explicit PatternQuery(const QString& hint);
+
+    /** @brief Check if the pattern compiles. */
+    bool isValid() const { return unanchored.isValid(); }
+    /** @brief Check if an entry matches from its beginning. */
+    bool matchesPrefix(const QString& entry) const;
+    /** @brief Check if an entry matches anywhere. */
+    bool matches(const QString& entry) const;
+    /**
+     * @brief Finds a prefix of an entry that no entry starting with it
+     *        matches from its beginning.
+     * 
+     * @return The length of the prefix, or -1 if there is none.
+     */
+    int deadPrefix(const QString& entry) const;
+    /** @brief Gets the literals contained in every match. */
+    const QStringList& requiredLiterals() const { return literals; }
+
+private:
+    /** @brief Check if some string starting with `prefix` matches from its beginning. */
+    bool isAlive(const QString& prefix) const;
+    /** @brief Extracts the literals required by a regex (conservatively). */
+    static QStringList regexLiterals(const QString& regex);
+
+    QRegularExpression anchored;
+    QRegularExpression unanchored;
+    QStringList        literals;
+};
@@ -0,0 +1,27 @@
+/**
+ * @file   postings.h
+ * @brief  Operations on posting lists (ordered entry indices).
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QVector>
+
+typedef QVector<int> postingList;
+
+/**
+ * @brief Keeps the entries of `res` also in `other`.
+ * 
+ * Gallops through `other`, so it takes O(|res| log(|other| / |res|))
+ * when `res` is the shortest, as it should be.
+ */
+void intersectPostings(postingList& res, const postingList& other);
+
+/** @brief Keeps the entries of `res` in any of `lists` (galloping through each). */
+void intersectUnion(postingList& res, const QVector<const postingList*>& lists);
+
+/** @brief Gets the entries in any of `lists`. */
+postingList unitePostings(const QVector<const postingList*>& lists);
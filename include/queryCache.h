@@ -0,0 +1,114 @@
+/**
+ * @file   queryCache.h
+ * @brief  The LRU cache of query results.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <list>
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+#include "consts.h"
+
+/**
+ * @class QueryCache
+ * @brief Bounded LRU cache from a query to its results.
+ * 
+ * Results are the entries decoded from the (front coded) engine list,
+ * so the cache owns their characters: they count in its memory cap.
+ * 
+ * Every invalidation bumps the cache version:
+ * results computed before are not inserted any more.
+ * 
+ * @note It is thread-safe.
+ */
+class QueryCache {
+public:
+    /** @brief The statistics for tuning the capacity. */
+    struct Stats {
+        qint64 hits;
+        qint64 misses;
+        /** @brief Entries dropped to respect the capacity. */
+        qint64 evictions;
+        /** @brief Entries dropped because the engine changed. */
+        qint64 invalidations;
+        qint64 bytes;
+        int    entries;
+    };
+
+    /**
+     * @param capacity The memory cap of the cache in bytes.
+     */
+    QueryCache(qint64 capacity = defaultCacheBytes);
+    ~QueryCache();
+
+    /** @brief Sets the memory cap (evicts the least recently used entries if needed). */
+    void setCapacity(qint64 capacity);
+    /** @brief Gets the maximum number of results an entry can hold (if they are short). */
+    int maxResults() const;
+
+    /**
+     * @brief Looks up the results of a query.
+     * 
+     * @param pattern       The pattern of the query.
+     * @param passes        The passes of the query (`SearchCursor::Pass`).
+     * @param[out] results  The cached results (on hit).
+     * @return If the query is cached.
+     */
+    bool lookup(const QString& pattern, int passes, QVector<QString>& results);
+    /** @brief Check if a query is cached (not counted in the statistics, nor marked as used). */
+    bool contains(const QString& pattern, int passes) const;
+    /**
+     * @brief Inserts the results of a query.
+     * 
+     * @param version The cache version (`version()`) when the query was started.
+     *                Nothing is inserted if the cache has been invalidated since.
+     */
+    void insert(
+        const QString& pattern, int passes,
+        const QVector<QString>& results, int version
+    );
+
+    /**
+     * @brief Drops the queries whose results may include one of `entries`
+     *        (i.e. the ones whose pattern occurs in an entry).
+     * 
+     * @param entries The entries added or removed.
+     */
+    void invalidate(const QVector<QString>& entries);
+    /** @brief Drops all the queries. */
+    void invalidateAll();
+
+    /** @brief Gets the current version. */
+    int version() const;
+    /** @brief Gets the statistics. */
+    Stats stats() const;
+
+private:
+    struct Node {
+        QString pattern;
+        int     passes;
+        QVector<QString> results;
+        qint64  bytes;
+    };
+    typedef std::list<Node>::iterator nodeIter;
+
+    static QString keyOf(const QString& pattern, int passes);
+    /** @brief Drops a node (`lock` held). */
+    void drop(nodeIter node);
+    /** @brief Evicts the least recently used entries until `capacity` is respected. */
+    void shrink();
+
+    /** @brief Most recently used first. */
+    std::list<Node>         nodes;
+    QHash<QString, nodeIter> index;
+    qint64                  capacity;
+    int                     curVersion;
+    Stats                   counters;
+    mutable QMutex          lock;
+};
@@ -0,0 +1,52 @@
+/**
+ * @file   queryClient.h
+ * @brief  The client of the local query service (blocking).
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtNetwork/QLocalSocket>
+
+#include "consts.h"
+#include "queryProtocol.h"
+
+/** 
+ * @class QueryClient
+ * @brief Sends batches of queries to the running instance (`QueryService`).
+ * 
+ * Requests may be pipelined: `send` several batches, then `receive`
+ * the replies in the same order.
+ */
+class QueryClient {
+public:
+    QueryClient();
+    ~QueryClient();
+
+    /** @return If the query service of the running instance answered. */
+    bool connectToService(int msecs = connectTimeout);
+    /** @brief Sends a batch without waiting for its reply. */
+    bool send(const QVector<ServiceQuery>& batch);
+    /** @brief Waits for the reply of the oldest batch sent. */
+    bool receive(QVector<ServiceReply>& replies, int msecs = -1);
+
+    /**
+     * @brief Runs the command line client.
+     * 
+     *   `--query <pattern>...`: prints the results of each pattern;
+     *   `--bench <file> [batch size]`: sends the patterns of a file (one per line)
+     *       in pipelined batches, and prints the throughput and the latency.
+     * 
+     * @param args The command line arguments.
+     * @return The exit code.
+     */
+    static int run(const QStringList& args);
+
+private:
+    static int query(QueryClient& client, const QStringList& patterns);
+    static int bench(QueryClient& client, const QString& filename, int batchSize);
+
+    QLocalSocket socket;
+};
@@ -0,0 +1,62 @@
+/**
+ * @file   queryProtocol.h
+ * @brief  The binary protocol of the local query service.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QIODevice>
+
+#include "consts.h"
+
+/** @brief A query of a batch. */
+struct ServiceQuery {
+    /** @brief Chosen by the client, echoed in the reply. */
+    quint32     id;
+    quint32     maxResults;
+    QString     pattern;
+};
+
+/** @brief The results of a query. */
+struct ServiceReply {
+    quint32     id;
+    QStringList results;
+};
+
+/** 
+ * @class QueryProtocol
+ * @brief Encodes / decodes the frames exchanged with the query service.
+ * 
+ * Every frame is a big-endian `quint32` length followed by the payload.
+ * A request payload is a batch of queries:
+ *   quint16 count, then per query: quint32 id, quint32 maxResults, string pattern;
+ * and its reply payload holds the results in the same order:
+ *   quint16 count, then per query: quint32 id, quint32 n, n strings.
+ * Strings are UTF-8, prefixed with their `quint16` length.
+ * 
+ * A client may send several requests without waiting (pipelining):
+ * the replies come back in the order of the requests.
+ */
+class QueryProtocol {
+public:
+    static QByteArray encodeRequest(const QVector<ServiceQuery>& batch);
+    /** @return If `payload` is a well-formed request. */
+    static bool decodeRequest(const QByteArray& payload, QVector<ServiceQuery>& batch);
+    static QByteArray encodeReply(const QVector<ServiceReply>& replies);
+    /** @return If `payload` is a well-formed reply. */
+    static bool decodeReply(const QByteArray& payload, QVector<ServiceReply>& replies);
+
+    /**
+     * @brief Takes the next complete frame out of a device.
+     * 
+     * @param device  The device to read (left untouched if the frame is incomplete).
+     * @param payload The payload of the frame.
+     * @param maxSize The largest payload accepted.
+     * @return 1 if a frame is taken, 0 if it is incomplete,
+     *         -1 if it is larger than `maxSize`.
+     */
+    static int takeFrame(QIODevice* device, QByteArray& payload, int maxSize);
+};
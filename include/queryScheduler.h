@@ -0,0 +1,57 @@
+/**
+ * @file   queryScheduler.h
+ * @brief  Schedules the queries typed by the user according to their cost.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+
+#include "consts.h"
+
+/** 
+ * @class QueryScheduler
+ * @brief Sits between the hint editor and the search engine.
+ * 
+ * It keeps a moving average of the recent query cost:
+ *   - Cheap queries are run right away;
+ *   - Expensive queries are debounced by a delay growing with the cost,
+ *     so bursts of keystrokes (and pastes) are coalesced into one query.
+ *     The delay never exceeds `maxDebounce` since the first pending keystroke.
+ * 
+ * Only the latest pattern is kept: the ones typed past are dropped.
+ */
+class QueryScheduler : public QObject {
+    Q_OBJECT
+public:
+    QueryScheduler(QObject* parent = nullptr);
+    ~QueryScheduler();
+
+    /** @brief Submits the latest pattern typed by the user. */
+    void submit(const QString& pattern);
+    /**
+     * @brief Reports the time a query took.
+     * 
+     * @param msecs The cost of the query in millisecond.
+     */
+    void reportCost(qint64 msecs);
+    /** @brief Gets the average cost of the recent queries (ms). */
+    double averageCost() const { return avgCost; }
+
+signals:
+    /** @brief Emitted when `pattern` should be queried. */
+    void queryReady(const QString& pattern);
+
+private slots:
+    void run_pending();
+
+private:
+    QTimer*         delayTimer;
+    /** @brief Elapsed time since the oldest keystroke not queried yet. */
+    QElapsedTimer   pendingSince;
+    QString         pending;
+    double          avgCost;
+};
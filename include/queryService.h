@@ -0,0 +1,82 @@
+/**
+ * @file   queryService.h
+ * @brief  Serves the symbol lookup to other local programs.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QMap>
+#include <QtCore/QThreadPool>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#include "consts.h"
+#include "packManager.h"
+#include "queryProtocol.h"
+
+/** 
+ * @class QueryService
+ * @brief Answers the queries of local clients (see `QueryProtocol`)
+ *        with the enabled packs.
+ * 
+ * The sockets live in the GUI thread, while the batches run on a thread pool
+ * on the engine snapshots, so the clients are served concurrently.
+ * 
+ * Backpressure: a client is not read any more while it has `maxClientBatches`
+ * batches in flight or `maxClientBacklog` reply bytes not sent yet. Its read
+ * buffer is bounded too, so a client sending too fast ends up blocked.
+ */
+class QueryService : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @param packs The packs queried, which must outlive the service.
+     */
+    QueryService(PackManager* packs, QObject* parent = nullptr);
+    /** @note Waits for the batches in flight. */
+    ~QueryService();
+
+    /** @brief Gets the name of the local server (unique per user). */
+    static QString serverName();
+
+    /** @return If the local server is listening. */
+    bool listen();
+    /** @brief Stops listening and disconnects the clients. */
+    void close();
+    bool isListening() const;
+
+private slots:
+    void on_new_connection();
+    void on_client_ready();
+    void on_client_disconnected();
+
+private:
+    struct Client {
+        QLocalSocket*   socket;
+        /** @brief The sequence number of the next batch dispatched. */
+        quint64         nextBatch;
+        /** @brief The sequence number of the next reply to send. */
+        quint64         nextReply;
+        /** @brief The replies done but not sent yet (out of order). */
+        QMap<quint64, QByteArray> done;
+    };
+
+    /** @brief Dispatches the complete requests of a client while it may. */
+    void dispatch(quint64 id);
+    /** @brief Sends the replies of a client in order (GUI thread). */
+    void finishBatch(quint64 id, quint64 seq, const QByteArray& reply);
+    /** @brief Runs a batch (on the pool). */
+    static QByteArray runBatch(
+        const QVector<const SearchEngine*>& engines,
+        const QVector<ServiceQuery>& batch
+    );
+
+    PackManager*            packs;
+    QLocalServer*           server;
+    QThreadPool             pool;
+    QHash<quint64, Client>  clients;
+    quint64                 nextClient;
+};
@@ -8,7 +8,23 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QFuture>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+
+#include "collationIndex.h"
 #include "consts.h"
+#include "frontCodedList.h"
+#include "ngramIndex.h"
+#include "patternQuery.h"
+#include "substringMatcher.h"
+#include "tokenIndex.h"
+#include "queryCache.h"
 #include "utils.h"
 
 typedef QVector<QString> strList;
@@ -25,12 +41,171 @@ typedef seqQueue<QString> strQueue;
  */
 int KMPSearch(const QString &parent, const QString &substring);
 
+/**
+ * @brief An immutable version of the engine content.
+ * 
+ * Once published, a snapshot is never modified: writers build the next one.
+ * It is released when the last reader (cursor) holding it is gone.
+ */
+struct EngineSnapshot : public std::enable_shared_from_this<EngineSnapshot> {
+    EngineSnapshot();
+    /** @note The postings are not copied: the copy is about to change. */
+    EngineSnapshot(const EngineSnapshot& other);
+
+    /**
+     * @brief Gets the n-gram postings of `srcList`.
+     * 
+     * @return Null until they are built: the first call starts building
+     *         them on a worker thread, so that no query waits for them.
+     * @note The snapshot must be held by a `snapshotPtr`.
+     */
+    std::shared_ptr<const NgramIndex> ngramIndex() const;
+    /** @brief Gets the token postings of `srcList` (null until built, see `ngramIndex`). */
+    std::shared_ptr<const TokenIndex> tokenIndex() const;
+    /** @brief Gets the collation order of `srcList`, built on first use. */
+    std::shared_ptr<const CollationIndex> collationIndex() const;
+
+    /** @brief Ordered entry list (front coded). */
+    FrontCodedList  srcList;
+    /** @brief New entries not ordered yet, scanned after `srcList` while they are merged. */
+    strList         rawList;
+    /** @brief If `srcList` holds all the entries (`rawList` is empty). */
+    bool            indexed;
+    /** @brief Bumped on every publication. */
+    int             version;
+    /** @brief Built for `ngramIndex` (atomically shared). */
+    mutable std::shared_ptr<const NgramIndex> ngrams;
+    /** @brief Built for `tokenIndex` (atomically shared). */
+    mutable std::shared_ptr<const TokenIndex> tokens;
+    /** @brief Set once the building of `ngrams` / `tokens` is started. */
+    mutable QAtomicInt ngramsStarted, tokensStarted;
+    /** @brief Built by `collationIndex` (atomically shared). */
+    mutable std::shared_ptr<const CollationIndex> collation;
+};
+
+typedef std::shared_ptr<const EngineSnapshot> snapshotPtr;
+
+/**
+ * @class SearchCursor
+ * @brief Resumable result stream of a query.
+ * 
+ * It yields the same entries in the same order as `SearchEngine::findRelative`,
+ * but only computes as many of them as requested by each `fetch`.
+ * 
+ * @note A cursor reads the snapshot it is created on, so it stays consistent
+ *       whatever happens to the engine afterwards.
+ */
+class SearchCursor {
+public:
+    /** @brief The passes of a query. */
+    enum Pass {
+        PrefixPass = 1,     /**< Entries starting with the pattern (in collation order). */
+        FuzzyPass  = 2,     /**< Other entries containing the pattern (all its terms). */
+        AllPasses  = PrefixPass | FuzzyPass
+    };
+
+    /** @brief Constructs a cursor with no result. */
+    SearchCursor();
+
+    /**
+     * @brief Retrieves the next results.
+     * 
+     * @param[out] out  The queue where results are appended.
+     * @param maxCount  The maximum number of results to retrieve.
+     * @param deadline  Stops scanning when it expires, even if fewer results are found.
+     * @return The number of results appended to `out`.
+     */
+    int fetch(
+        strQueue& out, int maxCount,
+        QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever)
+    );
+    /** @brief Check if all the results have been retrieved. */
+    bool atEnd() const { return done; }
+    /** @brief Gets the pattern of the query. */
+    const QString& pattern() const { return pat; }
+    /** @brief Check if each pass is yielded in order (false while the engine is building). */
+    bool isOrdered() const { return !linear; }
+
+private:
+    friend class SearchEngine;
+    /**
+     * @brief Computes the results on `snapshot`, and records them into `cache`.
+     * 
+     * @param cacheVersion The version of `cache` read before `snapshot` was.
+     */
+    SearchCursor(
+        const snapshotPtr& snapshot, const QString& pattern, int passes,
+        const std::shared_ptr<QueryCache>& cache, int cacheVersion
+    );
+    /** @brief Replays cached results. */
+    SearchCursor(const strList& results);
+    /** @brief Appends a result to `out` (and records it). */
+    void yield(strQueue& out, const QString& item);
+    /** @brief Gets an entry (valid until the next call). */
+    const QString& entryAt(int idx);
+    /** @brief Moves `reader` to an ordered entry. */
+    void seekReader(int idx);
+    /**
+     * @brief Check if an entry contains the pattern (all its terms, if several).
+     * 
+     * Ordered entries are tested as `reader` decodes them, Latin-1 keys included.
+     */
+    bool containsAt(int idx);
+    /** @brief Moves `pos` past the ordered blocks which cannot hold a match. */
+    void skipBlocks();
+    /** @brief `fetch` for a pattern query. */
+    int fetchPattern(strQueue& out, int maxCount, QDeadlineTimer deadline);
+
+    snapshotPtr snapshot;
+    /** @brief The cache to fill when all the results are computed. */
+    std::shared_ptr<QueryCache> cache;
+    /** @brief The cache version when the query is started. */
+    int     cacheVersion;
+    /** @brief The results computed so far (for the cache), or the cached ones. */
+    strList recorded;
+    /** @brief If it replays `recorded`. */
+    bool    replay;
+    QString pat;
+    /** @brief The compiled pattern (pattern queries only). */
+    std::shared_ptr<const PatternQuery> query;
+    /** @brief The whitespace-separated terms of `pat`, if more than one. */
+    QStringList terms;
+    /** @brief The matchers of `pat`, or of each of its `terms`. */
+    QVector<SubstringMatcher> matchers;
+    /** @brief The entries holding the literals of `query` / the `terms`, if narrowed down. */
+    QVector<int> candidates;
+    bool    narrowed;
+    /** @brief The grams every match holds (of `pat`, its `terms`, or the literals of `query`). */
+    GramFilter filter;
+    /** @brief The end of the block `pos` is in, if it may hold a match. */
+    int     filterEnd;
+    /** @brief The passes to go through. */
+    int     passes;
+    /** @brief If it scans all the entries (new ones are being merged). */
+    bool    linear;
+    /** @brief The range of entries starting with `pat`. */
+    int     prefixBegin, prefixEnd;
+    /** @brief The collation order of the entries, if the prefix pass follows it. */
+    std::shared_ptr<const CollationIndex> collation;
+    /** @brief The range of `collation` holding the entries starting with `pat` (or else the prefix range). */
+    int     collatedBegin, collatedEnd;
+    /** @brief The next entry to examine. */
+    int     pos;
+    /** @brief Decodes the ordered entries sequentially. */
+    FrontCodedList::Reader reader;
+    /** @brief If it is looking for entries containing `pat` (the second pass). */
+    bool    fuzzyPass;
+    bool    done;
+};
+
 /** 
  * @class SearchEngine
  * @brief Search engine for the project.
  * 
+ * Readers (`search`, `findRelative`) take the current snapshot without locking,
+ * so they may run on any thread and never wait for writers.
+ * Writers are serialized: each one publishes a new snapshot atomically.
  */
-
 class SearchEngine {
 public:
     SearchEngine();
@@ -52,6 +227,42 @@ public:
      *         If the `word` cannot be found in the engine, then return FALSE.
      */
     bool del(const QString &word);
+    /**
+     * @brief Adds & removes a batch of entries in one publication.
+     * 
+     * The changes are merged by a worker thread: queries see the
+     * previous entries until all of them are published.
+     * 
+     * @param added   The entries to add (duplicates are allowed).
+     * @param removed The entries to remove.
+     * @return The merge, finished once the changes are published.
+     */
+    QFuture<void> update(const strList &added, const strList &removed);
+
+    /**
+     * @brief Adds a batch of entries.
+     * 
+     * The entries can be queried right away through a linear scan,
+     * while the ordered list is built and published by a worker thread.
+     * 
+     * @param entries The entries (duplicates are allowed).
+     * @param indexed Called by the worker with the ordered snapshot, once published.
+     */
+    void load(
+        const strList& entries,
+        const std::function<void(const EngineSnapshot&)>& indexed = nullptr
+    );
+    /**
+     * @brief Replaces the entries by an ordered list (e.g. a mapped one, see `SharedIndex`).
+     * 
+     * @param list      The ordered entries.
+     * @param collation Their collation order.
+     */
+    void loadIndexed(
+        const FrontCodedList& list, const std::shared_ptr<const CollationIndex>& collation
+    );
+    /** @brief Check if the ordered list is in use (no building in progress). */
+    bool isIndexed() const { return snapshot()->indexed; }
 
     /**
      * @brief Finds the entries similiar to `pattern`.
@@ -60,10 +271,83 @@ public:
      * @return An <b>ordered</b> entry list including:
      *       - Entries start with `pattern`;
      *       - Entries contain `pattern`.
+     *       If `pattern` is a regex / glob (see `PatternQuery`),
+     *       the entries matching it from their beginning, then the other ones.
      */
-    strQueue findRelative(const QString &pattern);
+    strQueue findRelative(const QString &pattern) const;
+
+    /**
+     * @brief Starts a query whose results are retrieved progressively.
+     * 
+     * @param pattern The specific pattern string.
+     * @param passes  The passes (`SearchCursor::Pass`) to go through.
+     * @see findRelative
+     */
+    SearchCursor search(
+        const QString &pattern, int passes = SearchCursor::AllPasses
+    ) const;
+
+    /**
+     * @brief Warms the query cache with the likely next queries, in idle time.
+     * 
+     * A low priority worker runs the queries extending `pattern` by the
+     * characters which most often follow it in the entries starting with it,
+     * from the most frequent one on. Any earlier warming is cancelled.
+     * 
+     * @param pattern The query whose results are shown.
+     * @param passes  The queries (`SearchCursor::Pass`) run for each extension,
+     *                as the caller runs them.
+     */
+    void prefetch(const QString& pattern, const QVector<int>& passes);
+    /** @brief Stops warming the cache (a real query is coming). */
+    void cancelPrefetch();
+
+    /** @brief Removes all the entries. */
+    void clear();
+    /** @brief Gets the number of entries. */
+    int size() const;
+    /** @brief Gets the current snapshot (lock-free). */
+    snapshotPtr snapshot() const { return std::atomic_load(&current); }
+
+    /** @brief Sets the memory cap of the query cache in bytes. */
+    void setCacheCapacity(qint64 capacity) { cache->setCapacity(capacity); }
+    /** @brief Gets the hit/miss statistics of the query cache. */
+    QueryCache::Stats cacheStats() const { return cache->stats(); }
 
 private:
-    /** @brief Ordered entry list. */
-    strList srcList;
+    /**
+     * @brief Publishes the next snapshot (`writeLock` held, or by the builder).
+     * 
+     * @param next    The next snapshot.
+     * @param changed The entries added / removed, which invalidate the cached
+     *                queries they match (NULL to invalidate all of them).
+     */
+    void publish(EngineSnapshot* next, const strList* changed);
+    /** @brief Gets the `prefetchBranches` characters which most often follow `pattern` (sampled). */
+    QVector<QChar> likelyExtensions(
+        const EngineSnapshot& snapshot, const QString& pattern, int generation
+    ) const;
+    /** @brief Runs a query to the end (so that it is cached), unless the warming is cancelled. */
+    void warm(const QString& pattern, int passes, int generation) const;
+    /** @brief Check if the warming started as `generation` has been cancelled. */
+    bool prefetchCancelled(int generation) const {
+        return prefetchGeneration.loadAcquire() != generation;
+    }
+
+    /** @brief The published snapshot: only accessed atomically. */
+    snapshotPtr current;
+    /** @brief Serializes the writers. */
+    QMutex      writeLock;
+    /**
+     * @brief The ordered list being built (and published) by a worker.
+     * 
+     * Writers wait for it before building the next snapshot.
+     */
+    QFuture<void> building;
+    /** @brief Results of the recent queries, shared with the cursors filling it. */
+    std::shared_ptr<QueryCache> cache;
+    /** @brief The worker warming `cache` (one low priority thread). */
+    QThreadPool prefetchPool;
+    /** @brief Bumped by every warming started or cancelled. */
+    QAtomicInt  prefetchGeneration;
 };
@@ -0,0 +1,74 @@
+/**
+ * @file   sharedIndex.h
+ * @brief  Ordered entry lists shared by the instances through mapped files.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QtCore/QString>
+
+#include "collationIndex.h"
+#include "frontCodedList.h"
+
+/** 
+ * @class SharedIndex
+ * @brief Publishes the built index of a dictionary into a file, which the
+ *        other instances map read-only instead of building their own.
+ * 
+ * The file holds the arrays of the `FrontCodedList` & `CollationIndex`
+ * as they are in memory, so the mapped lists read them in place: all the
+ * instances share the same pages, and attaching costs a validation pass.
+ * 
+ * An index is tied to a version of its dictionary (size & modification
+ * time): a stale one is not attached, and is replaced by the next build.
+ * Files are replaced atomically, so a mapped version stays valid.
+ * 
+ * @note The index directory must be as trusted as the dictionaries:
+ *       the arrays are checked to be consistent, but not their contents.
+ */
+class SharedIndex {
+public:
+    /** @brief Identifies a version of a dictionary. */
+    struct Version {
+        qint64  size;
+        /** @brief The modification time (ms since epoch). */
+        qint64  modified;
+    };
+
+    /** @brief Gets the index file of a dictionary. */
+    static QString indexPath(const QString& dictionary);
+    /** @brief Gets the current version of a dictionary. */
+    static Version versionOf(const QString& dictionary);
+
+    /**
+     * @brief Maps the index of a dictionary, if it is up to date.
+     * 
+     * @param path           The index file.
+     * @param source         The current version of the dictionary.
+     * @param[out] list      The ordered entries.
+     * @param[out] collation Their collation order.
+     * @return FALSE if there is no such index (or not a valid one).
+     */
+    static bool attach(
+        const QString& path, const Version& source,
+        FrontCodedList& list, std::shared_ptr<const CollationIndex>& collation
+    );
+    /**
+     * @brief Writes the index of a dictionary (replacing the previous one).
+     * 
+     * @param path      The index file.
+     * @param source    The version of the dictionary that was read.
+     * @param list      The ordered entries.
+     * @param collation Their collation order.
+     * @return If the index has been written.
+     */
+    static bool publish(
+        const QString& path, const Version& source,
+        const FrontCodedList& list, const CollationIndex& collation
+    );
+};
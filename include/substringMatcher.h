@@ -0,0 +1,43 @@
+/**
+ * @file   substringMatcher.h
+ * @brief  Substring tests on plain & front coded entries.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include "frontCodedList.h"
+
+/**
+ * @class SubstringMatcher
+ * @brief Checks if entries hold a substring.
+ * 
+ * The same kernel is instantiated for UTF-16 code units and Latin-1 bytes,
+ * so the Latin-1 keys of a `FrontCodedList` are searched as they are stored
+ * (twice the characters per compare), without decoding the whole entries.
+ */
+class SubstringMatcher {
+public:
+    /** @brief Constructs a matcher of the empty string (every entry). */
+    SubstringMatcher();
+    explicit SubstringMatcher(const QString& needle);
+
+    /** @brief Check if `text` holds the substring. */
+    bool matches(const QString& text) const;
+    /** @brief Check if the current entry of `reader` holds the substring. */
+    bool matches(const FrontCodedList::Reader& reader) const;
+
+private:
+    QString     needle;
+    /** @brief `needle` in Latin-1, if it can be (see `latin1`). */
+    QByteArray  needle8;
+    /** @brief If `needle` is Latin-1 (or else no Latin-1 key holds it). */
+    bool        latin1;
+    /** @brief If `needle` holds a `pairDelim`, so it may span the key & the tail. */
+    bool        spansKey;
+};
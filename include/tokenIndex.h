@@ -0,0 +1,47 @@
+/**
+ * @file   tokenIndex.h
+ * @brief  The inverted index of the tokens of an ordered entry list.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QStringList>
+
+#include "consts.h"
+#include "frontCodedList.h"
+#include "postings.h"
+
+/** 
+ * @class TokenIndex
+ * @brief Maps every token (whitespace-separated word) of the entries to
+ *        the ordered indices of the entries holding it.
+ * 
+ * A term without whitespace can only occur inside a token, so the entries
+ * containing it are the ones holding a token which contains it.
+ */
+class TokenIndex {
+public:
+    explicit TokenIndex(const FrontCodedList& list);
+
+    /**
+     * @brief Finds the entries which may contain all the terms.
+     * 
+     * The terms are resolved from the one with the fewest entries on.
+     * A term matching more than `maxUnionProbes` distinct tokens is left
+     * to be checked on the candidates.
+     * 
+     * @param terms           The terms (without whitespace).
+     * @param[out] candidates The ordered indices of the candidates.
+     * @return FALSE if every term matches too many tokens (not narrowed down).
+     */
+    bool candidates(const QStringList& terms, postingList& candidates) const;
+
+private:
+    /** @brief The distinct tokens. */
+    QStringList             tokens;
+    /** @brief The entries holding each token. */
+    QVector<postingList>    postings;
+};
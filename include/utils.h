@@ -10,6 +10,10 @@
 #pragma once
 #include "assert.h"
 
+#include <iterator>
+#include <memory>
+#include <utility>
+
 /** @brief The minimum size of the basic containers. */
 static constexpr int minimumSize = 10;
 
@@ -33,150 +37,299 @@ template <class comparable>
 bool smaller(const comparable& a, const comparable& b) { return a < b; }
 
 
-/** @brief Stack template based on linear structures. */
+/** @brief Uninitialized buffer for `inlineSize` elements inside a container. */
+template <class elemT, int inlineSize>
+struct inlineBuffer {
+    alignas(elemT) unsigned char raw[inlineSize * sizeof(elemT)];
+    elemT* get() { return reinterpret_cast<elemT*>(raw); }
+    const elemT* get() const { return reinterpret_cast<const elemT*>(raw); }
+};
+
+template <class elemT>
+struct inlineBuffer<elemT, 0> {
+    elemT* get() const { return nullptr; }
+};
+
+/**
+ * @brief Uninitialized element storage shared by the containers.
+ * 
+ * The storage only owns raw memory: elements are constructed in place
+ * by the containers, so reserving capacity never constructs elements.
+ * Up to `inlineSize` elements live in the object itself without any allocation.
+ * 
+ * @tparam inlineSize The inline (small-buffer) capacity.
+ * @tparam allocT     The allocator for the capacity beyond `inlineSize`.
+ */
+template <class elemT, int inlineSize, class allocT>
+class seqStorage {
+protected:
+    typedef std::allocator_traits<allocT> allocTraits;
+
+    elemT* data;        /**< The element slots. */
+    int maxSize;        /**< The number of slots in `data`. */
+    allocT alloc;       /**< The allocator. */
+    inlineBuffer<elemT, inlineSize> buf;    /**< The inline slots. */
+
+    seqStorage(int initSize, const allocT& a) : alloc(a) {
+        acquire(initSize > 0 ? initSize : 0);
+    }
+    ~seqStorage() { release(); }
+
+    /** @brief Gets at least `n` uninitialized slots as `data`. */
+    void acquire(int n) {
+        maxSize = n <= inlineSize ? inlineSize : n;
+        data = allocate(maxSize);
+    }
+    /** @brief Gives back the slots of `data` (elements must be destroyed before). */
+    void release() {
+        deallocate(data, maxSize);
+        data = buf.get(); maxSize = inlineSize;
+    }
+    elemT* allocate(int n) {
+        return n <= inlineSize ? buf.get() : allocTraits::allocate(alloc, n);
+    }
+    void deallocate(elemT* p, int n) {
+        if (p != buf.get()) allocTraits::deallocate(alloc, p, n);
+    }
+    /** @brief If the elements live in the inline buffer. */
+    bool isInline() const { return data == buf.get(); }
+    /** @brief The capacity after a growth. */
+    int grownSize() const { return maxSize ? maxSize * 2 : minimumSize; }
+
+    template <class... argTs>
+    void construct(elemT* p, argTs&&... args) {
+        allocTraits::construct(alloc, p, std::forward<argTs>(args)...);
+    }
+    void destroy(elemT* p) { allocTraits::destroy(alloc, p); }
+    /** @brief Moves an element into an uninitialized slot, destroying the source. */
+    void relocate(elemT* dst, elemT* src) {
+        construct(dst, std::move(*src));
+        destroy(src);
+    }
+};
+
+/**
+ * @brief Forward iterator over a ring buffer.
+ * 
+ * @see seqQueue
+ */
 template <class elemT>
-class seqStack {
+class ringIterator {
+public:
+    typedef std::forward_iterator_tag   iterator_category;
+    typedef elemT                       value_type;
+    typedef std::ptrdiff_t              difference_type;
+    typedef elemT*                      pointer;
+    typedef elemT&                      reference;
+
+    ringIterator(elemT* data, int maxSize, int front, int offset)
+        : data(data), maxSize(maxSize), front(front), offset(offset) {}
+
+    elemT& operator*() const {
+        int idx = front + offset;
+        return data[idx < maxSize ? idx : idx - maxSize];
+    }
+    elemT* operator->() const { return &**this; }
+    ringIterator& operator++() { ++offset; return *this; }
+    ringIterator operator++(int) { ringIterator tmp = *this; ++offset; return tmp; }
+    bool operator==(const ringIterator& other) const { return offset == other.offset; }
+    bool operator!=(const ringIterator& other) const { return offset != other.offset; }
+
+private:
+    elemT* data;
+    int maxSize;
+    int front;
+    int offset;     /**< Logical index from the head. */
+};
+
+
+/**
+ * @brief Stack template based on linear structures.
+ * 
+ * Iterates from the bottom to the top.
+ */
+template <class elemT, int inlineSize = 0, class allocT = std::allocator<elemT>>
+class seqStack : protected seqStorage<elemT, inlineSize, allocT> {
 private:
-	elemT* data;                /**< Data list for the stack. */
-	int maxSize;                /**< Maximum size of the inner list. */
+    typedef seqStorage<elemT, inlineSize, allocT> storage;
+    using storage::data;
+    using storage::maxSize;
+
 	int topIdx;                 /**< Current top index of the inner list. */
 
     /** @brief Reallocates and expands space when adding element to a full stack. */
 	inline void doubleSpace();
+    /** @brief Takes the elements of `cp` and leaves it empty. */
+    inline void takeFrom(seqStack& cp);
 public:
-    /** 
+    typedef elemT*       iterator;
+    typedef const elemT* const_iterator;
+
+    /**
      * @brief Constructor of the stack.
      * 
      * @param initSize The initial size of the stack.
      */
-	seqStack(int initSize = minimumSize) : maxSize(initSize), topIdx(-1) {
-		data = new elemT[maxSize];
-	}
-    seqStack(const seqStack& cp) {
-        maxSize = cp.maxSize, topIdx = cp.topIdx;
-        data = new elemT[maxSize];
-        for (int i = 0; i < maxSize; ++i)
-            data[i] = cp.data[i];
-    }
-    seqStack(seqStack&& cp) {
-        maxSize = cp.maxSize, topIdx = cp.topIdx;
-        data = cp.data;
-        cp.data = nullptr;
-    }
-	~seqStack() { if (data) delete[] data; }
+	seqStack(int initSize = minimumSize, const allocT& a = allocT())
+        : storage(initSize, a), topIdx(-1) {}
+    seqStack(const seqStack& cp) : storage(cp.topIdx + 1, cp.alloc), topIdx(-1) {
+        for (const elemT& dt : cp) push(dt);
+    }
+    seqStack(seqStack&& cp) : storage(0, std::move(cp.alloc)), topIdx(-1) {
+        takeFrom(cp);
+    }
+	~seqStack() { clear(); }
     inline seqStack& operator=(const seqStack& cp);
     inline seqStack& operator=(seqStack&& cp);
 
     /** @brief Check if the stack is empty now. */
 	bool isempty() const { return topIdx == -1; }
+    /** @brief Gets the number of elements in the stack. */
+    int size() const { return topIdx + 1; }
     /** @brief Push an element into the stack. */
-	void push(const elemT& dt) {
-		if (topIdx >= maxSize - 1) 
-			doubleSpace(); 
-		data[++topIdx] = dt;
-	}
-    /** 
+	void push(const elemT& dt) { emplace(dt); }
+    /** @brief Push an element into the stack. */
+	void push(elemT&& dt) { emplace(std::move(dt)); }
+    /** @brief Constructs an element in place on the top of the stack. */
+    template <class... argTs>
+    elemT& emplace(argTs&&... args) {
+		if (topIdx >= maxSize - 1) {
+            /* `args` may refer to an element: build it before moving them. */
+            elemT dt(std::forward<argTs>(args)...);
+			doubleSpace();
+            this->construct(data + topIdx + 1, std::move(dt));
+        } else {
+            this->construct(data + topIdx + 1, std::forward<argTs>(args)...);
+        }
+		return data[++topIdx];
+    }
+    /**
      * @brief Retrieve the top element from the stack and remove it from stack.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
-	elemT pop() { 
+	elemT pop() {
 		if (topIdx == -1) throw ContainerNoElement();
-		return data[topIdx--];
+        elemT ans = std::move(data[topIdx]);
+        this->destroy(data + topIdx--);
+		return ans;
 	}
-    /** 
+    /**
      * @brief Retrieve the top element from the stack.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
-	elemT top() const { 
+	const elemT& top() const {
 		if (topIdx == -1) throw ContainerNoElement();
-		return data[topIdx]; 
+		return data[topIdx];
 	}
     /** @brief Clear the stack. */
-    void clear() { topIdx = -1; }
+    void clear() {
+        while (topIdx >= 0) this->destroy(data + topIdx--);
+    }
+
+    iterator begin() { return data; }
+    iterator end() { return data + topIdx + 1; }
+    const_iterator begin() const { return data; }
+    const_iterator end() const { return data + topIdx + 1; }
 };
 
-template <class elemT>
-seqStack<elemT>& seqStack<elemT>::operator=(const seqStack& cp) {
+template <class elemT, int inlineSize, class allocT>
+seqStack<elemT, inlineSize, allocT>&
+seqStack<elemT, inlineSize, allocT>::operator=(const seqStack& cp) {
     if (this == &cp) return *this;
-    if (data) delete[] data;
+    clear();
+    if (maxSize < cp.topIdx + 1) {
+        this->release();
+        this->acquire(cp.topIdx + 1);
+    }
+    for (const elemT& dt : cp) push(dt);
 
-    maxSize = cp.maxSize, topIdx = cp.topIdx;
-    data = new elemT[maxSize];
-    for (int i = 0; i < maxSize; ++i)
-        data[i] = cp.data[i];
-    
     return *this;
 }
 
-template <class elemT>
-seqStack<elemT>& seqStack<elemT>::operator=(seqStack&& cp) {
-    if (data) delete[] data;
+template <class elemT, int inlineSize, class allocT>
+seqStack<elemT, inlineSize, allocT>&
+seqStack<elemT, inlineSize, allocT>::operator=(seqStack&& cp) {
+    if (this == &cp) return *this;
+    clear();
+    this->release();
+    this->alloc = std::move(cp.alloc);
+    takeFrom(cp);
 
-    maxSize = cp.maxSize, topIdx = cp.topIdx;
-    data = cp.data;
-    cp.data = nullptr;
-    
     return *this;
 }
 
-template <class elemT>
-void seqStack<elemT>::doubleSpace() {
+template <class elemT, int inlineSize, class allocT>
+void seqStack<elemT, inlineSize, allocT>::takeFrom(seqStack& cp) {
+    if (cp.isInline()) {
+        /* Inline elements cannot be stolen: move them one by one. */
+        for (int i = 0; i <= cp.topIdx; ++i)
+            this->relocate(data + i, cp.data + i);
+    } else {
+        data = cp.data; maxSize = cp.maxSize;
+        cp.data = cp.buf.get(); cp.maxSize = inlineSize;
+    }
+    topIdx = cp.topIdx;
+    cp.topIdx = -1;
+}
+
+template <class elemT, int inlineSize, class allocT>
+void seqStack<elemT, inlineSize, allocT>::doubleSpace() {
 	elemT* tmp = data;
-	data = new elemT[maxSize * 2];
+    int tmpSize = maxSize;
+    maxSize = this->grownSize();
+    data = this->allocate(maxSize);
 	for (int i = 0; i <= topIdx; ++i)
-		data[i] = tmp[i];
-	delete[] tmp;
-	maxSize *= 2;
+        this->relocate(data + i, tmp + i);
+    this->deallocate(tmp, tmpSize);
 }
 
 
-/** @brief Queue template based on linear structures. */
-template <class elemT>
-class seqQueue {
+/**
+ * @brief Queue template based on linear structures.
+ * 
+ * Iterates from the head to the tail.
+ */
+template <class elemT, int inlineSize = 0, class allocT = std::allocator<elemT>>
+class seqQueue : protected seqStorage<elemT, inlineSize, allocT> {
 protected:
-    elemT* data;    /**< The data list for the queue. */
+    typedef seqStorage<elemT, inlineSize, allocT> storage;
+    using storage::data;
+    using storage::maxSize;
+
     int front;      /**< The head index of the inner list. */
-    int rear;       /**< The tail index of the inner list. */
-    int maxSize;    /**< The maximum size of the queue. */
-    /** 
-     * @brief The length of current queue.
-     * 
-     * @note It helps with distinguish the empty 
-     *       situation from the full situation.
-     */
+    /** @brief The length of current queue. */
     int len;
 
+    /** @brief Wraps an index of the inner list. */
+    int wrap(int idx) const { return idx < maxSize ? idx : idx - maxSize; }
+    /** @brief The tail index of the inner list. */
+    int rear() const { return wrap(front + len - 1); }
+
     /** @brief Reallocates and expands space when adding element to a full queue. */
     inline void doubleSpace();
+    /** @brief Takes the elements of `cp` and leaves it empty. */
+    inline void takeFrom(seqQueue& cp);
 
 public:
-    /** 
+    typedef ringIterator<elemT>       iterator;
+    typedef ringIterator<const elemT> const_iterator;
+
+    /**
      * @brief Constructor of the queue.
      * 
      * @param initSize The initial size of the queue.
      */
-    seqQueue(int initSize = minimumSize) :maxSize(initSize) {
-        data = new elemT[initSize];
-        front = len = 0; rear = maxSize - 1;
-    }
-    seqQueue(const seqQueue& cp) {
-        front = cp.front, rear = cp.rear;
-        maxSize = cp.maxSize; len = cp.len;
-        data = new elemT[maxSize];
-        for (int i = 0; i < maxSize; ++i)
-            data[i] = cp.data[i];
-    }
-    seqQueue(seqQueue&& cp) {
-        front = cp.front, rear = cp.rear;
-        maxSize = cp.maxSize; len = cp.len;
-        data = cp.data;
-        cp.data = nullptr;
-    }
-    virtual ~seqQueue() {
-        if (data) delete[] data;
+    seqQueue(int initSize = minimumSize, const allocT& a = allocT())
+        : storage(initSize, a), front(0), len(0) {}
+    seqQueue(const seqQueue& cp) : storage(cp.len, cp.alloc), front(0), len(0) {
+        for (const elemT& dt : cp) enQueue(dt);
+    }
+    seqQueue(seqQueue&& cp) : storage(0, std::move(cp.alloc)), front(0), len(0) {
+        takeFrom(cp);
     }
+    virtual ~seqQueue() { clear(); }
     inline seqQueue& operator=(const seqQueue& cp);
     inline seqQueue& operator=(seqQueue&& cp);
 
@@ -184,85 +337,124 @@ public:
     bool isempty() const { return len == 0; }
     /** @brief Gets the length of the current queue. */
     int length() const { return len; }
-    /** 
+    /**
      * @brief Gets the head of the queue.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
-    elemT getHead() const {
+    const elemT& getHead() const {
         if (isempty()) throw ContainerNoElement();
         return data[front];
     }
-    /** 
+    /**
      * @brief Gets the tail of the queue.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
-    elemT getTail() const {
+    const elemT& getTail() const {
         if (isempty()) throw ContainerNoElement();
-        return data[rear];
+        return data[rear()];
     }
     /** @brief Push the element to the tail of the queue. */
-    void enQueue(const elemT& dt) {
-        if (len == maxSize) doubleSpace();
-        rear = (rear+1) % maxSize;
-        data[rear] = dt;
+    void enQueue(const elemT& dt) { emplace(dt); }
+    /** @brief Push the element to the tail of the queue. */
+    void enQueue(elemT&& dt) { emplace(std::move(dt)); }
+    /** @brief Constructs an element in place at the tail of the queue. */
+    template <class... argTs>
+    elemT& emplace(argTs&&... args) {
+        elemT* slot;
+        if (len == maxSize) {
+            /* `args` may refer to an element: build it before moving them. */
+            elemT dt(std::forward<argTs>(args)...);
+            doubleSpace();
+            slot = data + len;
+            this->construct(slot, std::move(dt));
+        } else {
+            slot = data + wrap(front + len);
+            this->construct(slot, std::forward<argTs>(args)...);
+        }
         ++len;
+        return *slot;
     }
-    /** 
+    /**
      * @brief Gets the head of the queue and remove it from current queue.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
     elemT deQueue() {
         if (isempty()) throw ContainerNoElement();
-        elemT ans = data[front];
-        front = (front+1) % maxSize;
+        elemT ans = std::move(data[front]);
+        this->destroy(data + front);
+        front = wrap(front + 1);
         --len;
         return ans;
     }
     /** @brief Clear the queue. */
     void clear() {
-        front = len = 0; rear = maxSize - 1;
+        for (int i = 0; i < len; ++i)
+            this->destroy(data + wrap(front + i));
+        front = len = 0;
     }
+
+    iterator begin() { return iterator(data, maxSize, front, 0); }
+    iterator end() { return iterator(data, maxSize, front, len); }
+    const_iterator begin() const { return const_iterator(data, maxSize, front, 0); }
+    const_iterator end() const { return const_iterator(data, maxSize, front, len); }
 };
 
-template <class elemT>
-seqQueue<elemT>& seqQueue<elemT>::operator=(const seqQueue& cp) {
+template <class elemT, int inlineSize, class allocT>
+seqQueue<elemT, inlineSize, allocT>&
+seqQueue<elemT, inlineSize, allocT>::operator=(const seqQueue& cp) {
     if (this == &cp) return *this;
-    if (data) delete[] data;
-
-    front = cp.front, rear = cp.rear;
-    maxSize = cp.maxSize; len = cp.len;
-    data = new elemT[maxSize];
-    for (int i = 0; i < maxSize; ++i)
-        data[i] = cp.data[i];
-    
+    clear();
+    if (maxSize < cp.len) {
+        this->release();
+        this->acquire(cp.len);
+    }
+    for (const elemT& dt : cp) enQueue(dt);
+
     return *this;
 }
 
-template <class elemT>
-seqQueue<elemT>& seqQueue<elemT>::operator=(seqQueue&& cp) {
-    if (data) delete[] data;
-
-    front = cp.front, rear = cp.rear;
-    maxSize = cp.maxSize; len = cp.len;
-    data = cp.data;
-    cp.data = nullptr;
+template <class elemT, int inlineSize, class allocT>
+seqQueue<elemT, inlineSize, allocT>&
+seqQueue<elemT, inlineSize, allocT>::operator=(seqQueue&& cp) {
+    if (this == &cp) return *this;
+    clear();
+    this->release();
+    this->alloc = std::move(cp.alloc);
+    takeFrom(cp);
 
     return *this;
 }
 
-template <class elemT>
-void seqQueue<elemT>::doubleSpace() {
+template <class elemT, int inlineSize, class allocT>
+void seqQueue<elemT, inlineSize, allocT>::takeFrom(seqQueue& cp) {
+    if (cp.isInline()) {
+        /* Inline elements cannot be stolen: move them one by one. */
+        for (int i = 0; i < cp.len; ++i)
+            this->relocate(data + i, cp.data + cp.wrap(cp.front + i));
+        front = 0;
+    } else {
+        data = cp.data; maxSize = cp.maxSize; front = cp.front;
+        cp.data = cp.buf.get(); cp.maxSize = inlineSize;
+    }
+    len = cp.len;
+    cp.front = cp.len = 0;
+}
+
+template <class elemT, int inlineSize, class allocT>
+void seqQueue<elemT, inlineSize, allocT>::doubleSpace() {
     elemT* tmp = data;
-    data = new elemT[maxSize*2];
+    int tmpSize = maxSize;
+    maxSize = this->grownSize();
+    data = this->allocate(maxSize);
     for (int i = 0; i < len; ++i) {
-        data[i] = tmp[(front+i)%maxSize];
+        int idx = front + i;
+        this->relocate(data + i, tmp + (idx < tmpSize ? idx : idx - tmpSize));
     }
-    maxSize *= 2;
-    front = 0; rear = len - 1;
-    delete[] tmp;
+    front = 0;
+    this->deallocate(tmp, tmpSize);
 }
 
 /**
@@ -270,50 +462,79 @@ void seqQueue<elemT>::doubleSpace() {
  * 
  * @see seqQueue
  */
-template <class elemT>
-class seqDeque : public seqQueue<elemT> {
+template <class elemT, int inlineSize = 0, class allocT = std::allocator<elemT>>
+class seqDeque : public seqQueue<elemT, inlineSize, allocT> {
 public:
-    seqDeque(int initSize = minimumSize)
-        : seqQueue<elemT>(initSize) {}
+    seqDeque(int initSize = minimumSize, const allocT& a = allocT())
+        : seqQueue<elemT, inlineSize, allocT>(initSize, a) {}
     /** @brief Insert an element to the head of the deque. */
-    void prepend(const elemT& dt) {
-        if (this->len == this->maxSize) this->doubleSpace();
-        this->front = (this->front - 1 + this->maxSize) % this->maxSize;
-        this->data[this->front] = dt;
+    void prepend(const elemT& dt) { emplace_front(dt); }
+    /** @brief Insert an element to the head of the deque. */
+    void prepend(elemT&& dt) { emplace_front(std::move(dt)); }
+    /** @brief Constructs an element in place at the head of the deque. */
+    template <class... argTs>
+    elemT& emplace_front(argTs&&... args) {
+        int idx;
+        if (this->len == this->maxSize) {
+            /* `args` may refer to an element: build it before moving them. */
+            elemT dt(std::forward<argTs>(args)...);
+            this->doubleSpace();
+            idx = this->maxSize - 1;
+            this->construct(this->data + idx, std::move(dt));
+        } else {
+            idx = this->front == 0 ? this->maxSize - 1 : this->front - 1;
+            this->construct(this->data + idx, std::forward<argTs>(args)...);
+        }
+        this->front = idx;
         ++this->len;
+        return this->data[idx];
     }
     /** @brief Retrieve an element from the tail of the deque. */
     elemT pop_back() {
         if (this->isempty()) throw ContainerNoElement();
-        elemT res = this->data[this->rear];
-        this->rear = (this->rear - 1 + this->maxSize) % this->maxSize;
+        elemT* slot = this->data + this->rear();
+        elemT res = std::move(*slot);
+        this->destroy(slot);
         --this->len;
         return res;
     }
 };
 
-/** @brief Priority queue template based on binary heap. */
-template <class elemT, bool (*comp)(const elemT&, const elemT&)=greater>
-class priorityQueue {
+/**
+ * @brief Priority queue template based on binary heap.
+ * 
+ * Iterates in the heap order.
+ */
+template <
+    class elemT, bool (*comp)(const elemT&, const elemT&)=greater,
+    int inlineSize = 0, class allocT = std::allocator<elemT>
+>
+class priorityQueue : protected seqStorage<elemT, inlineSize, allocT> {
+    typedef seqStorage<elemT, inlineSize, allocT> storage;
+    /* `data` is the binary heap. */
+    using storage::data;
+    using storage::maxSize;
 public:
-    /** 
+    typedef const elemT* const_iterator;
+
+    /**
      * @brief Constructor of the priority queue.
      * 
      * @param initSize The initial size of the priority queue.
      */
-    priorityQueue(int initSize=minimumSize);
+    priorityQueue(int initSize=minimumSize, const allocT& a = allocT());
     /**
      * @brief Construct a priority queue from a existing array.
      * 
      * @param initArray Initial element array.
      * @param arrSize   The size of the array.
      * 
-     * @note This is superior to the time complexity of 
+     * @note This is superior to the time complexity of
      *       using the default constructor and then entering the queue one by one.
      *       O(n) for the former and O(n^2) for the latter.
      */
-    priorityQueue(const elemT* initArray, int arrSize);
-    ~priorityQueue();
+    priorityQueue(const elemT* initArray, int arrSize, const allocT& a = allocT());
+    ~priorityQueue() { clear(); }
 
     priorityQueue(const priorityQueue& cp);
     priorityQueue(priorityQueue&& cp);
@@ -321,23 +542,35 @@ public:
     priorityQueue& operator=(priorityQueue&& cp);
 
     /** @brief Push the element to the priority queue. */
-    inline void enQueue(const elemT& element);
-    /** 
+    void enQueue(const elemT& element) { emplace(element); }
+    /** @brief Push the element to the priority queue. */
+    void enQueue(elemT&& element) { emplace(std::move(element)); }
+    /** @brief Constructs an element in place and pushes it to the priority queue. */
+    template <class... argTs>
+    inline void emplace(argTs&&... args);
+    /**
      * @brief Gets the head of the priority queue and remove it from current queue.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
     inline elemT deQueue();
-    /** 
+    /**
      * @brief Gets the head of the priority queue.
      * 
      * @exception Raise ContainerNoElement when empty.
      */
-    elemT front() const { return pHeap[0]; }
+    const elemT& front() const {
+        if (length < 1) throw ContainerNoElement();
+        return data[0];
+    }
     /** @brief Check if the priority queue is empty now. */
     bool empty() const { return length == 0; }
     /** @brief Gets the current length of the priority queue. */
     int size() const { return length; }
+    /** @brief Clear the priority queue. */
+    void clear() {
+        while (length > 0) this->destroy(data + --length);
+    }
 
     /**
      * @brief Decrease the value of a certain key.
@@ -346,134 +579,172 @@ public:
      */
     void decreaseKeyTo(int idx, const elemT& lowerValInHeap);
 
+    const_iterator begin() const { return data; }
+    const_iterator end() const { return data + length; }
+
 private:
-    elemT*  pHeap;      /**< Binary heap. */
     int     length;     /**< Current length. */
-    int     maxSize;    /**< The maximum size of the priority queue. */
 
     /** @brief Reallocates and expands space when adding element to a full queue. */
     void expand();
+    /** @brief Takes the elements of `cp` and leaves it empty. */
+    void takeFrom(priorityQueue& cp);
     /**
      * @brief Adjusting the ordering of a binary heap.
      * 
      * @param i Adjusting from i node.
      */
     void percolateDown(int i);
+    /**
+     * @brief Adjusting the ordering of a binary heap upwards.
+     * 
+     * @param i Adjusting from i node.
+     */
+    void percolateUp(int i);
 };
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>::priorityQueue(int initSize) {
-    assert(initSize > 0);
+#define PQ_TEMPLATE \
+    template < \
+        class elemT, bool (*comp)(const elemT&, const elemT&), \
+        int inlineSize, class allocT \
+    >
+#define PQ_CLASS priorityQueue<elemT, comp, inlineSize, allocT>
 
-    pHeap = new elemT[initSize];
-    length = 0; maxSize = initSize;
+PQ_TEMPLATE
+PQ_CLASS::priorityQueue(int initSize, const allocT& a)
+    : storage(initSize, a), length(0) {
+    assert(initSize > 0);
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>::priorityQueue(const elemT* initArr, int arrSize) {
-    length = arrSize; maxSize = arrSize + minimumSize;
-    pHeap = new elemT[maxSize];
-    for (int i = 0; i < arrSize; ++i)
-        pHeap[i] = initArr[i];
+PQ_TEMPLATE
+PQ_CLASS::priorityQueue(const elemT* initArr, int arrSize, const allocT& a)
+    : storage(arrSize + minimumSize, a), length(0) {
+    for (; length < arrSize; ++length)
+        this->construct(data + length, initArr[length]);
     for (int i = arrSize / 2 - 1; i >= 0; --i)
         percolateDown(i);
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>::~priorityQueue() { if (pHeap) delete[] pHeap; }
-
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>::priorityQueue(const priorityQueue& cp) {
-    length = cp.length;
-    maxSize = cp.maxSize;
-    pHeap = new elemT[maxSize];
-    for (int i = 0; i < maxSize; ++i)
-        pHeap[i] = cp.pHeap[i];
+PQ_TEMPLATE
+PQ_CLASS::priorityQueue(const priorityQueue& cp)
+    : storage(cp.length, cp.alloc), length(0) {
+    for (; length < cp.length; ++length)
+        this->construct(data + length, cp.data[length]);
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>::priorityQueue(priorityQueue&& cp) {
-    length = cp.length;
-    maxSize = cp.maxSize;
-    pHeap = cp.pHeap;
-    cp.pHeap = nullptr;
+PQ_TEMPLATE
+PQ_CLASS::priorityQueue(priorityQueue&& cp)
+    : storage(0, std::move(cp.alloc)), length(0) {
+    takeFrom(cp);
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>& priorityQueue<elemT, comp>::operator=(const priorityQueue& cp) {
+PQ_TEMPLATE
+PQ_CLASS& PQ_CLASS::operator=(const priorityQueue& cp) {
     if (this == &cp) return *this;
+    clear();
+    if (maxSize < cp.length) {
+        this->release();
+        this->acquire(cp.length);
+    }
+    for (; length < cp.length; ++length)
+        this->construct(data + length, cp.data[length]);
 
-    length = cp.length;
-    maxSize = cp.maxSize;
-    delete[] pHeap;
-    pHeap = new elemT[maxSize];
-    for (int i = 0; i < maxSize; ++i)
-        pHeap[i] = cp.pHeap[i];
-    
     return *this;
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-priorityQueue<elemT, comp>& priorityQueue<elemT, comp>::operator=(priorityQueue&& cp) {
-    length = cp.length;
-    maxSize = cp.maxSize;
-    pHeap = cp.pHeap;
-    cp.pHeap = nullptr;
+PQ_TEMPLATE
+PQ_CLASS& PQ_CLASS::operator=(priorityQueue&& cp) {
+    if (this == &cp) return *this;
+    clear();
+    this->release();
+    this->alloc = std::move(cp.alloc);
+    takeFrom(cp);
     return *this;
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-void priorityQueue<elemT, comp>::percolateDown(int i) {
-    elemT elementI = pHeap[i];
+PQ_TEMPLATE
+void PQ_CLASS::takeFrom(priorityQueue& cp) {
+    if (cp.isInline()) {
+        /* Inline elements cannot be stolen: move them one by one. */
+        for (int i = 0; i < cp.length; ++i)
+            this->relocate(data + i, cp.data + i);
+    } else {
+        data = cp.data; maxSize = cp.maxSize;
+        cp.data = cp.buf.get(); cp.maxSize = inlineSize;
+    }
+    length = cp.length;
+    cp.length = 0;
+}
+
+PQ_TEMPLATE
+void PQ_CLASS::percolateDown(int i) {
+    elemT elementI = std::move(data[i]);
     int nextIdx = 2 * i + 1;
     while (nextIdx < length) {
-        if (nextIdx + 1 < length && comp(pHeap[nextIdx + 1], pHeap[nextIdx]))
+        if (nextIdx + 1 < length && comp(data[nextIdx + 1], data[nextIdx]))
             ++nextIdx;
-        if (comp(elementI, pHeap[nextIdx])) break;
-        pHeap[i] = pHeap[nextIdx];
+        if (comp(elementI, data[nextIdx])) break;
+        data[i] = std::move(data[nextIdx]);
         i = nextIdx;
         nextIdx = 2 * i + 1;
     }
-    pHeap[i] = elementI;
+    data[i] = std::move(elementI);
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-void priorityQueue<elemT, comp>::expand() {
-    elemT* newHeap = new elemT[maxSize * 2];
-    for (int i = 0; i < length; ++i)
-        newHeap[i] = pHeap[i];
-    delete[] pHeap;
-    pHeap = newHeap;
-    maxSize *= 2;
-}
-
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-void priorityQueue<elemT, comp>::enQueue(const elemT& element) {
-    if (length == maxSize) expand();
-    int i = length, nextIdx = (i - 1) / 2;
-    ++length;
+PQ_TEMPLATE
+void PQ_CLASS::percolateUp(int i) {
+    elemT elementI = std::move(data[i]);
+    int nextIdx = (i - 1) / 2;
     while (i > 0) {
-        if (comp(pHeap[nextIdx], element)) break;
-        pHeap[i] = pHeap[nextIdx];
+        if (comp(data[nextIdx], elementI)) break;
+        data[i] = std::move(data[nextIdx]);
         i = nextIdx;
         nextIdx = (i - 1) / 2;
     }
-    pHeap[i] = element;
+    data[i] = std::move(elementI);
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-elemT priorityQueue<elemT, comp>::deQueue() {
+PQ_TEMPLATE
+void PQ_CLASS::expand() {
+    elemT* newHeap = this->allocate(this->grownSize());
+    for (int i = 0; i < length; ++i)
+        this->relocate(newHeap + i, data + i);
+    this->deallocate(data, maxSize);
+    maxSize = this->grownSize();
+    data = newHeap;
+}
+
+PQ_TEMPLATE
+template <class... argTs>
+void PQ_CLASS::emplace(argTs&&... args) {
+    if (length == maxSize) {
+        /* `args` may refer to an element: build it before moving them. */
+        elemT element(std::forward<argTs>(args)...);
+        expand();
+        this->construct(data + length, std::move(element));
+    } else {
+        this->construct(data + length, std::forward<argTs>(args)...);
+    }
+    percolateUp(length++);
+}
+
+PQ_TEMPLATE
+elemT PQ_CLASS::deQueue() {
     if (length < 1) throw ContainerNoElement();
-    
-    elemT ans = pHeap[0];
-    pHeap[0] = pHeap[length - 1];
+
+    elemT ans = std::move(data[0]);
     --length;
-    percolateDown(0);
+    if (length > 0) data[0] = std::move(data[length]);
+    this->destroy(data + length);
+    if (length > 0) percolateDown(0);
     return ans;
 }
 
-template <class elemT, bool (*comp)(const elemT&, const elemT&)>
-void priorityQueue<elemT, comp>::decreaseKeyTo(int idx, const elemT& lowerValInHeap) {
-    pHeap[idx] = lowerValInHeap;
+PQ_TEMPLATE
+void PQ_CLASS::decreaseKeyTo(int idx, const elemT& lowerValInHeap) {
+    data[idx] = lowerValInHeap;
     percolateDown(idx);
 }
+
+#undef PQ_CLASS
+#undef PQ_TEMPLATE
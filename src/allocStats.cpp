@@ -0,0 +1,102 @@
+#include <errno.h>
+#include <stdlib.h>
+
+#include "allocStats.h"
+
+#ifdef ALLOC_STATS
+
+#include <new>
+
+#include <QtCore/QString>
+
+#include "logger.h"
+
+/** @brief Zero-initialized in the static TLS: no allocation on first use. */
+static thread_local AllocCounters counters;
+
+#ifdef __GLIBC__
+
+/* Qt containers allocate with `malloc`, so it is interposed as a whole
+   (`operator new` of libstdc++ ends up here as well). */
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    ++counters.allocs;
+    counters.bytes += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    ++counters.allocs;
+    counters.bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    ++counters.allocs;
+    counters.bytes += size;
+    if (ptr) ++counters.frees;
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    ++counters.allocs;
+    counters.bytes += size;
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    ++counters.allocs;
+    counters.bytes += size;
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+void free(void* ptr) {
+    if (ptr) ++counters.frees;
+    __libc_free(ptr);
+}
+}
+
+#else
+
+/* Elsewhere only `operator new` is counted (the other forms call it). */
+void* operator new(size_t size) {
+    ++counters.allocs;
+    counters.bytes += size;
+    if (void* ptr = malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) ++counters.frees;
+    free(ptr);
+}
+
+#endif
+
+AllocCounters threadAllocCounters() {
+    return counters;
+}
+
+AllocScope::AllocScope(const char* name, quint64 budget)
+    : name(name), budget(budget), start(counters) {}
+
+AllocScope::~AllocScope() {
+    AllocCounters end = counters;
+    quint64 allocs = end.allocs - start.allocs;
+    QString msg = QString("Allocations in %1: %2 (%3 bytes), frees: %4")
+                    .arg(name).arg(allocs).arg(end.bytes - start.bytes)
+                    .arg(end.frees - start.frees);
+    if (budget && allocs > budget)
+        stdLogger.Warning(QString("%1 over the budget of %2").arg(msg).arg(budget).toStdString().c_str());
+    else
+        stdLogger.Debug(msg.toStdString().c_str());
+}
+
+#endif
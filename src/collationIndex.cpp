@@ -0,0 +1,110 @@
+#include <string.h>
+
+#include <algorithm>
+
+#include "collationIndex.h"
+
+static void appendUtf8(QByteArray& out, uint ucs4) {
+    if (ucs4 < 0x80) {
+        out.append(char(ucs4));
+    } else if (ucs4 < 0x800) {
+        out.append(char(0xc0 | (ucs4 >> 6)));
+        out.append(char(0x80 | (ucs4 & 0x3f)));
+    } else if (ucs4 < 0x10000) {
+        out.append(char(0xe0 | (ucs4 >> 12)));
+        out.append(char(0x80 | ((ucs4 >> 6) & 0x3f)));
+        out.append(char(0x80 | (ucs4 & 0x3f)));
+    } else {
+        out.append(char(0xf0 | (ucs4 >> 18)));
+        out.append(char(0x80 | ((ucs4 >> 12) & 0x3f)));
+        out.append(char(0x80 | ((ucs4 >> 6) & 0x3f)));
+        out.append(char(0x80 | (ucs4 & 0x3f)));
+    }
+}
+
+
+CollationIndex::CollationIndex(const FrontCodedList& list) {
+    std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+    QVector<int>& offsets = storage->keyOffset;
+    offsets.reserve(list.size() + 1);
+    offsets.append(0);
+    for (FrontCodedList::Reader reader(&list, 0); !reader.atEnd(); reader.next()) {
+        appendKey(storage->keys, reader.value());
+        offsets.append(storage->keys.size());
+    }
+    storage->keys.squeeze();
+
+    QVector<int>& sorted = storage->order;
+    sorted.resize(list.size());
+    for (int i = 0; i < sorted.size(); ++i) sorted[i] = i;
+    const char* data = storage->keys.constData();
+    const int* offset = offsets.constData();
+    std::sort(sorted.begin(), sorted.end(), [data, offset](int a, int b) {
+        int alen = offset[a + 1] - offset[a], blen = offset[b + 1] - offset[b];
+        int res = memcmp(data + offset[a], data + offset[b], qMin(alen, blen));
+        if (res != 0) return res < 0;
+        return alen != blen ? alen < blen : a < b;
+    });
+
+    owner = storage;
+    keys = data;
+    keyOffset = offset;
+    order = sorted.constData();
+    count = sorted.size();
+}
+
+CollationIndex::CollationIndex(
+    const std::shared_ptr<const void>& owner,
+    const char* keys, const int* keyOffset, const int* order, int count
+) : owner(owner), keys(keys), keyOffset(keyOffset), order(order), count(count) {}
+
+QByteArray CollationIndex::sortKey(const QString& text) {
+    QByteArray res;
+    appendKey(res, text);
+    return res;
+}
+
+void CollationIndex::prefixRange(const QString& prefix, int& begin, int& end) const {
+    QByteArray key = sortKey(prefix);
+    begin = std::partition_point(order, order + count, [this, &key](int idx) {
+        return comparePrefix(idx, key) < 0;
+    }) - order;
+    end = std::partition_point(order + begin, order + count, [this, &key](int idx) {
+        return comparePrefix(idx, key) == 0;
+    }) - order;
+}
+
+qint64 CollationIndex::bytes() const {
+    return sizeof(*this) + keyOffset[count] + qint64(2 * count + 1) * sizeof(int);
+}
+
+void CollationIndex::appendKey(QByteArray& keys, const QString& text) {
+    /* ASCII is folded in place. */
+    int ascii = 0;
+    for (; ascii < text.size() && text[ascii].unicode() < 0x80; ++ascii) {
+        char ch = char(text[ascii].unicode());
+        keys.append(ch >= 'A' && ch <= 'Z' ? char(ch - 'A' + 'a') : ch);
+    }
+    if (ascii == text.size()) return;
+
+    /* Decomposed, a character is its base followed by its accents. */
+    QString folded = text.mid(ascii).normalized(QString::NormalizationForm_D).toCaseFolded();
+    const QChar* p = folded.constData();
+    const QChar* end = p + folded.size();
+    while (p < end) {
+        uint ucs4 = p->unicode();
+        if (p->isHighSurrogate() && p + 1 < end && p[1].isLowSurrogate()) {
+            ucs4 = QChar::surrogateToUcs4(p[0], p[1]);
+            ++p;
+        }
+        ++p;
+        if (QChar::category(ucs4) != QChar::Mark_NonSpacing) appendUtf8(keys, ucs4);
+    }
+}
+
+int CollationIndex::comparePrefix(int idx, const QByteArray& key) const {
+    int len = keyOffset[idx + 1] - keyOffset[idx];
+    int res = memcmp(keys + keyOffset[idx], key.constData(), qMin(len, key.size()));
+    if (res != 0) return res;
+    return len < key.size() ? -1 : 0;
+}
@@ -0,0 +1,178 @@
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <QtCore/QtAlgorithms>
+
+#include "dictParser.h"
+
+/**
+ * @brief Gets the length of the UTF-8 sequence at `p`.
+ * 
+ * @return 0 if it is invalid (truncated, overlong, surrogate or beyond U+10FFFF).
+ */
+static int sequenceLength(const uchar* p, int avail) {
+    uchar lead = p[0];
+    int len;
+    uchar lo = 0x80, hi = 0xBF;
+    if (lead < 0x80) return 1;
+    else if (lead >= 0xC2 && lead <= 0xDF) len = 2;
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        len = 3;
+        if (lead == 0xE0) lo = 0xA0;
+        else if (lead == 0xED) hi = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        len = 4;
+        if (lead == 0xF0) lo = 0x90;
+        else if (lead == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    if (avail < len || p[1] < lo || p[1] > hi) return 0;
+    for (int i = 2; i < len; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+    }
+    return len;
+}
+
+/**
+ * @brief Validates the sequences starting in [`from`, `to`).
+ * 
+ * @param[out] validEnd The end of the last sequence validated (maybe past `to`).
+ */
+static bool validate(const uchar* data, int size, int from, int to, int& validEnd) {
+    int pos = from;
+    while (pos < to) {
+        int len = sequenceLength(data + pos, size - pos);
+        if (len == 0) return false;
+        pos += len;
+    }
+    if (pos > validEnd) validEnd = pos;
+    return true;
+}
+
+#ifdef __SSE2__
+/** @brief The UTF-8 state carried from a block to the next one. */
+struct Utf8Carry {
+    /** @brief The continuation bytes required at the beginning of the next block. */
+    uint required;
+    /** @brief If the last byte is E0, ED, F0 or F4 (which restrict the next one). */
+    uint e0, ed, f0, f4;
+};
+
+/** @brief Gets the mask of the bytes in [`lo`, `hi`] (`flipped` holds the bytes ^ 0x80). */
+static inline uint rangeMask(__m128i flipped, int lo, int hi) {
+    /* The unsigned order is the signed one once the sign bits are flipped. */
+    __m128i below = _mm_cmplt_epi8(flipped, _mm_set1_epi8(char(lo ^ 0x80)));
+    __m128i above = _mm_cmpgt_epi8(flipped, _mm_set1_epi8(char(hi ^ 0x80)));
+    return ~uint(_mm_movemask_epi8(_mm_or_si128(below, above))) & 0xFFFF;
+}
+
+static inline uint equalMask(__m128i block, int value) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(char(value))));
+}
+
+/**
+ * @brief Validates a block of 16 bytes holding non-ASCII ones.
+ * 
+ * The continuation bytes must be exactly the ones the leading bytes
+ * require, and the second bytes after E0, ED, F0 & F4 are restricted to
+ * reject the overlong forms, the surrogates and what is beyond U+10FFFF.
+ * 
+ * @param[out] cont The mask of the continuation bytes.
+ * @param[out] four The mask of the leading bytes of 4-byte sequences.
+ */
+static bool validateBlock(__m128i block, Utf8Carry& carry, uint& cont, uint& four) {
+    __m128i flipped = _mm_xor_si128(block, _mm_set1_epi8(char(0x80)));
+    cont = rangeMask(flipped, 0x80, 0xBF);
+    four = rangeMask(flipped, 0xF0, 0xF4);
+    uint two = rangeMask(flipped, 0xC2, 0xDF), three = rangeMask(flipped, 0xE0, 0xEF);
+    uint bad = rangeMask(flipped, 0xC0, 0xC1) | rangeMask(flipped, 0xF5, 0xFF);
+    uint required = ((two | three | four) << 1) | ((three | four) << 2) | (four << 3)
+                  | carry.required;
+
+    uint e0 = equalMask(block, 0xE0), ed = equalMask(block, 0xED);
+    uint f0 = equalMask(block, 0xF0), f4 = equalMask(block, 0xF4);
+    uint wrong = (((e0 << 1) | carry.e0) & rangeMask(flipped, 0x80, 0x9F))
+               | (((ed << 1) | carry.ed) & rangeMask(flipped, 0xA0, 0xBF))
+               | (((f0 << 1) | carry.f0) & rangeMask(flipped, 0x80, 0x8F))
+               | (((f4 << 1) | carry.f4) & rangeMask(flipped, 0x90, 0xBF));
+
+    carry.required = required >> 16;
+    carry.e0 = e0 >> 15;
+    carry.ed = ed >> 15;
+    carry.f0 = f0 >> 15;
+    carry.f4 = f4 >> 15;
+    return !bad && !wrong && (required & 0xFFFF) == cont;
+}
+#endif
+
+int DictParser::skipBom(const char* data, int size) {
+    return size >= 3 && uchar(data[0]) == 0xEF && uchar(data[1]) == 0xBB && uchar(data[2]) == 0xBF
+         ? 3 : 0;
+}
+
+bool DictParser::scan(const char* data, int size, QVector<LineSpan>& lines) {
+    const uchar* bytes = reinterpret_cast<const uchar*>(data);
+    /* The bytes before `validEnd` are validated; `units` is the UTF-16 offset of byte `i`. */
+    int validEnd = 0, units = 0, i = 0;
+    LineSpan cur = { 0, -1, 0 };
+
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n'), delim = _mm_set1_epi8(pairDelim);
+    Utf8Carry carry = { 0, 0, 0, 0, 0 };
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        uint newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        uint delims = _mm_movemask_epi8(_mm_cmpeq_epi8(block, delim));
+        /* Continuation bytes take no code unit, and 4-byte sequences take two. */
+        uint cont = 0, four = 0;
+        if (_mm_movemask_epi8(block)) {
+            if (!validateBlock(block, carry, cont, four)) return false;
+        } else if (carry.required) {
+            return false;
+        }
+        for (uint events = newlines | delims; events; events &= events - 1) {
+            int bit = qCountTrailingZeroBits(events);
+            uint below = (1u << bit) - 1;
+            int at = units + bit;
+            if (cont | four)
+                at += int(qPopulationCount(four & below)) - int(qPopulationCount(cont & below));
+            if (newlines & (1u << bit)) {
+                cur.end = at;
+                lines.append(cur);
+                cur.begin = at + 1;
+                cur.delim = -1;
+            } else if (cur.delim < 0) {
+                cur.delim = at;
+            }
+        }
+        units += 16;
+        if (cont | four) units += int(qPopulationCount(four)) - int(qPopulationCount(cont));
+    }
+    if (carry.required) {
+        /* The last sequence goes on in the tail: validated as a whole. */
+        int lead = i - 1;
+        while (lead > i - 4 && (bytes[lead] & 0xC0) == 0x80) --lead;
+        if (!validate(bytes, size, lead, lead + 1, validEnd)) return false;
+    }
+#endif
+
+    for (; i < size; ++i) {
+        uchar ch = bytes[i];
+        if (ch >= 0x80 && i >= validEnd && !validate(bytes, size, i, i + 1, validEnd))
+            return false;
+        if (ch == '\n') {
+            cur.end = units;
+            lines.append(cur);
+            cur.begin = units + 1;
+            cur.delim = -1;
+        } else if (ch == pairDelim && cur.delim < 0) {
+            cur.delim = units;
+        }
+        if ((ch & 0xC0) != 0x80) units += (ch & 0xF8) == 0xF0 ? 2 : 1;
+    }
+    cur.end = units;
+    if (cur.end > cur.begin) lines.append(cur);
+    return true;
+}
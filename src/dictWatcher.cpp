@@ -0,0 +1,137 @@
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFutureWatcher>
+
+#include "dictWatcher.h"
+#include "fileHandler.h"
+#include "logger.h"
+
+/** @brief The result of reloading a watched file. */
+struct DictDiff {
+    bool          ok;
+    QStringList   added;
+    QStringList   removed;
+    QSet<QString> snapshot;
+};
+
+/**
+ * @brief Re-reads a file and diffs it against its previous snapshot.
+ * 
+ * @note Runs on a worker thread, so it only touches its own arguments.
+ */
+static DictDiff diffSource(const QString& filename, const QSet<QString>& previous) {
+    DictDiff res;
+    QString contents;
+    res.ok = FileHandler::readText(filename, contents);
+    if (!res.ok) return res;
+
+    QStringList lines = FileHandler::splitLines(contents);
+    res.snapshot.reserve(lines.length());
+    foreach (const QString& line, lines) {
+        res.snapshot.insert(line);
+        if (!previous.contains(line))
+            res.added.append(line);
+    }
+    foreach (const QString& line, previous) {
+        if (!res.snapshot.contains(line))
+            res.removed.append(line);
+    }
+    return res;
+}
+
+
+DictWatcher::DictWatcher(QObject* parent)
+    : QObject(parent) {
+    fsWatcher = new QFileSystemWatcher(this);
+    connect(
+        fsWatcher, SIGNAL(fileChanged(const QString&)),
+        this, SLOT(on_file_changed(const QString&))
+    );
+
+    delayTimer = new QTimer(this);
+    delayTimer->setSingleShot(true);
+    delayTimer->setInterval(reloadDelay);
+    connect(delayTimer, SIGNAL(timeout()), this, SLOT(reload_dirty()));
+}
+
+DictWatcher::~DictWatcher() {
+
+}
+
+void DictWatcher::watch(const QString& filename) {
+    QString path = QFileInfo(filename).absoluteFilePath();
+    if (!QFile::exists(path)) return;
+    snapshots.insert(path, QSet<QString>());
+    fsWatcher->addPath(path);
+    startReload(path, false);
+}
+
+void DictWatcher::watch(const QString& filename, const QStringList& baseline) {
+    QString path = QFileInfo(filename).absoluteFilePath();
+    if (!QFile::exists(path)) return;
+    snapshots.insert(path, QSet<QString>(baseline.begin(), baseline.end()));
+    fsWatcher->addPath(path);
+    startReload(path, true);
+}
+
+void DictWatcher::unwatch(const QString& filename) {
+    QString path = QFileInfo(filename).absoluteFilePath();
+    snapshots.remove(path);
+    dirty.remove(path);
+    fsWatcher->removePath(path);
+}
+
+bool DictWatcher::providedElsewhere(const QString& line, const QString& except) const {
+    QHash<QString, QSet<QString>>::const_iterator iter = snapshots.constBegin();
+    for (; iter != snapshots.constEnd(); ++iter) {
+        if (iter.key() != except && iter.value().contains(line))
+            return true;
+    }
+    return false;
+}
+
+void DictWatcher::on_file_changed(const QString& path) {
+    if (!snapshots.contains(path)) return;
+    dirty.insert(path);
+    delayTimer->start();
+}
+
+void DictWatcher::reload_dirty() {
+    foreach (const QString& path, dirty) {
+        /* Editors saving by rename make the watcher drop the path. */
+        if (!fsWatcher->files().contains(path) && QFile::exists(path))
+            fsWatcher->addPath(path);
+        if (!running.contains(path)) {
+            dirty.remove(path);
+            startReload(path, true);
+        }
+        /* else: reloaded again when the running one finishes. */
+    }
+}
+
+void DictWatcher::startReload(const QString& filename, bool report) {
+    running.insert(filename);
+
+    QFutureWatcher<DictDiff>* watcher = new QFutureWatcher<DictDiff>(this);
+    connect(watcher, &QFutureWatcher<DictDiff>::finished, this, [=]() {
+        DictDiff diff = watcher->result();
+        watcher->deleteLater();
+        running.remove(filename);
+
+        if (!snapshots.contains(filename)) return;
+        if (!diff.ok) {
+            stdLogger.Warning(
+                QString("Failed to reload dictionary: %1. Keep the loaded entries.")
+                .arg(filename).toStdString().c_str()
+            );
+        } else {
+            snapshots[filename] = diff.snapshot;
+            if (report && (!diff.added.isEmpty() || !diff.removed.isEmpty()))
+                emit sourceChanged(filename, diff.added, diff.removed);
+        }
+        if (dirty.contains(filename)) delayTimer->start();
+    });
+    watcher->setFuture(
+        QtConcurrent::run(diffSource, filename, snapshots.value(filename))
+    );
+}
@@ -1,4 +1,25 @@
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QFileInfo>
+
+#include "dictParser.h"
 #include "fileHandler.h"
+#include "packArchive.h"
+
+/** @brief The lines of a chunk of a compressed dictionary. */
+struct ParsedChunk {
+    bool         ok;
+    QStringList  lines;
+    QVector<int> delims;
+};
+
+/** @brief Decompresses & parses a chunk (on a worker thread). */
+static ParsedChunk parseChunk(const QByteArray& archive, const PackChunk& chunk) {
+    ParsedChunk res;
+    QByteArray text = PackArchive::inflate(archive, chunk);
+    res.ok = !text.isNull()
+        && FileHandler::parseUtf8(text.constData(), text.size(), res.lines, res.delims);
+    return res;
+}
 
 FileHandler::FileHandler() {
     index = 0;
@@ -15,30 +36,178 @@ bool FileHandler::loadFromText(const QString& filename) {
         rawFile.open(QIODevice::WriteOnly);
         rawFile.close();
     }
-    if (!rawFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (!rawFile.open(QIODevice::ReadOnly))
         return false;
-    QTextStream stream(&rawFile);
-    QString contents = stream.readAll();
+    QByteArray bytes = rawFile.readAll();
+    rawFile.close();
+    if (PackArchive::isArchive(bytes))
+        return loadArchive(bytes);
+
+    int bom = DictParser::skipBom(bytes.constData(), bytes.size());
+    QStringList parsed;
+    QVector<int> parsedDelims;
+    if (!parseUtf8(bytes.constData() + bom, bytes.size() - bom, parsed, parsedDelims)) {
+        /* Not UTF-8: decoded by the codec of the locale. */
+        QString contents;
+        if (!readText(filename, contents))
+            return false;
+        loadFromString(contents);
+        return true;
+    }
+    bytes.clear();
+    for (int i = 0; i < parsed.length(); ++i) {
+        insertLine(parsed[i], parsedDelims[i]);
+    }
+    return true;
+}
 
-    loadFromString(contents);
+bool FileHandler::parseUtf8(
+    const char* data, int size, QStringList& lines, QVector<int>& delims
+) {
+    QVector<LineSpan> spans;
+    if (!DictParser::scan(data, size, spans))
+        return false;
 
-    rawFile.close();
+    QString text = QString::fromUtf8(data, size);
+    lines.reserve(lines.length() + spans.size());
+    delims.reserve(delims.size() + spans.size());
+    foreach (const LineSpan& span, spans) {
+        int begin = span.begin, end = span.end, delim = span.delim;
+        while (begin < end && text[begin].isSpace()) ++begin;
+        while (end > begin && text[end - 1].isSpace()) --end;
+        if (begin == end) continue;
+        /* The delimiter found may be in the spaces trimmed. */
+        if (delim >= 0 && delim < begin) delim = text.indexOf(pairDelim, begin);
+        if (delim >= end) delim = -1;
+        lines.append(text.mid(begin, end - begin));
+        delims.append(delim < 0 ? -1 : delim - begin);
+    }
     return true;
 }
 
+bool FileHandler::loadArchive(const QByteArray& archive) {
+    QVector<PackChunk> chunks;
+    if (!PackArchive::index(archive, chunks))
+        return false;
+
+    /* All the chunks at once, inserted in order as soon as they are ready. */
+    QVector<QFuture<ParsedChunk>> parsed;
+    parsed.reserve(chunks.size());
+    foreach (const PackChunk& chunk, chunks)
+        parsed.append(QtConcurrent::run(parseChunk, archive, chunk));
+
+    int first = lines.length();
+    bool ok = true;
+    for (int i = 0; ok && i < parsed.size(); ++i) {
+        const ParsedChunk chunk = parsed[i].result();
+        ok = chunk.ok;
+        for (int j = 0; ok && j < chunk.lines.length(); ++j)
+            insertLine(chunk.lines[j], chunk.delims[j]);
+    }
+    if (!ok) {
+        /* The tasks left own a copy of the archive: they are not waited for. */
+        for (int i = first; i < lines.length(); ++i) lineSet.remove(lines[i]);
+        lines.erase(lines.begin() + first, lines.end());
+        delims.resize(first);
+    }
+    return ok;
+}
+
 void FileHandler::loadFromString(const QString& rawString) {
-    int start = lines.length(), stop;
-    lines.append(rawString.split('\n'));
-    stop = lines.length();
-    for (int i = start; i < stop; ++i) {
-        lines[i] = lines[i].trimmed();
+    foreach (const QString& line, rawString.split('\n')) {
+        QString trimmed = line.trimmed();
+        if (!trimmed.isEmpty()) insertLine(trimmed, trimmed.indexOf(pairDelim));
     }
-    lines.removeAll("");
-    lines.removeDuplicates();
+}
+
+bool FileHandler::readText(const QString& filename, QString& contents) {
+    QFile rawFile(filename);
+    if (!rawFile.open(QIODevice::ReadOnly))
+        return false;
+    if (PackArchive::isArchive(rawFile.peek(sizeof(quint32)))) {
+        QByteArray text;
+        bool ok = PackArchive::unpack(rawFile.readAll(), text);
+        rawFile.close();
+        contents = QString::fromUtf8(text);
+        return ok;
+    }
+    rawFile.setTextModeEnabled(true);
+    QTextStream stream(&rawFile);
+    contents = stream.readAll();
+    rawFile.close();
+    return true;
+}
+
+QStringList FileHandler::splitLines(const QString& rawString) {
+    QStringList res = rawString.split('\n');
+    for (int i = 0; i < res.length(); ++i) {
+        res[i] = res[i].trimmed();
+    }
+    res.removeAll("");
+    res.removeDuplicates();
+    return res;
+}
+
+bool FileHandler::parseLine(const QString& line, QString& key, QString& value) {
+    int sp = line.indexOf(pairDelim);
+    value = line.mid(0, sp);
+    if (sp > 0) {
+        key = line.mid(sp + 1);
+        return true;
+    }
+    key = undefinedKey;
+    return false;
+}
+
+bool FileHandler::addLine(const QString& line) {
+    QString trimmed = line.trimmed();
+    /* Keep the read pointer behind lines that are already retrieved. */
+    bool retrieved = index >= lines.length();
+    if (trimmed.isEmpty() || !insertLine(trimmed, trimmed.indexOf(pairDelim)))
+        return false;
+    if (retrieved) ++index;
+    return true;
+}
+
+QStringList FileHandler::removeLines(const QStringList& toRemove) {
+    QStringList res;
+    QSet<QString> removed;
+    foreach (const QString& line, toRemove) {
+        QString trimmed = line.trimmed();
+        if (!lineSet.remove(trimmed)) continue;
+        removed.insert(trimmed);
+        res.append(trimmed);
+    }
+    if (removed.isEmpty()) return res;
+
+    /* The kept lines are moved down in one pass. */
+    int kept = 0, retrieved = index;
+    for (int i = 0; i < lines.length(); ++i) {
+        if (removed.contains(lines[i])) {
+            if (i < index) --retrieved;
+            continue;
+        }
+        if (kept != i) {
+            lines[kept] = lines[i];
+            delims[kept] = delims[i];
+        }
+        ++kept;
+    }
+    lines.erase(lines.begin() + kept, lines.end());
+    delims.resize(kept);
+    index = retrieved;
+    return res;
 }
 
 bool FileHandler::saveAsText(const QString& filename) {
     QFile rawFile(filename);
+    if (QFileInfo(filename).suffix().toLower() == packArchiveSuffix) {
+        if (!rawFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+        bool ok = rawFile.write(PackArchive::pack(lines)) >= 0;
+        rawFile.close();
+        return ok;
+    }
     if (!rawFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
         return false;
     foreach (QString line, lines) {
@@ -49,15 +218,19 @@ bool FileHandler::saveAsText(const QString& filename) {
     return true;
 }
 
+bool FileHandler::insertLine(const QString& trimmed, int delim) {
+    int size = lineSet.size();
+    lineSet.insert(trimmed);
+    if (lineSet.size() == size) return false;
+    lines.append(trimmed);
+    delims.append(delim);
+    return true;
+}
+
 bool FileHandler::getWordPair(QString& key, QString& value) {
     if (index >= lines.length()) return false;
 
-    QString curWord = lines[index];
-    int sp = curWord.indexOf(pairDelim);
-    value = curWord.mid(0, sp);
-    if (sp > 0) key = curWord.mid(sp + 1);
-    else {
-        key = undefinedKey;
+    if (!parseLine(lines[index], key, value)) {
         stdLogger.Warning(
             QString("Imported '%1' with no key.")
             .arg(value).toStdString().c_str()
@@ -67,3 +240,26 @@ bool FileHandler::getWordPair(QString& key, QString& value) {
 
     return true;
 }
+
+void FileHandler::takeEntries(QVector<QString>& entries) {
+    entries.reserve(entries.size() + lines.length() - index);
+    for (; index < lines.length(); ++index) {
+        const QString& line = lines[index];
+        int delim = delims[index];
+        /* `<value><delim><key>` in the file, `<key><delim><value>` in the engine. */
+        QString entry;
+        if (delim > 0) {
+            entry.reserve(line.length());
+            entry.append(line.constData() + delim + 1, line.length() - delim - 1);
+            entry.append(QChar(pairDelim));
+            entry.append(line.constData(), delim);
+        } else {
+            stdLogger.Warning(
+                QString("Imported '%1' with no key.")
+                .arg(line).toStdString().c_str()
+            );
+            entry = QString(undefinedKey) + pairDelim + line;
+        }
+        entries.append(entry);
+    }
+}
@@ -0,0 +1,455 @@
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "frontCodedList.h"
+
+/** @brief Lengths take one code unit, or two from 0x8000 on. */
+static void putLength(QVector<ushort>& units, int len) {
+    if (len < 0x8000) {
+        units.append(ushort(len));
+    } else {
+        units.append(ushort(0x8000 | (len >> 15)));
+        units.append(ushort(len & 0x7fff));
+    }
+}
+
+static int getLength(const ushort*& p) {
+    int len = *p++;
+    if (len & 0x8000) len = ((len & 0x7fff) << 15) | *p++;
+    return len;
+}
+
+/** @brief Reads a length without going past `end`. */
+static bool getLength(const ushort*& p, const ushort* end, int& len) {
+    if (p >= end || ((*p & 0x8000) && p + 1 >= end)) return false;
+    len = getLength(p);
+    return true;
+}
+
+static void putChars(QVector<ushort>& units, const QChar* chars, int len) {
+    int old = units.size();
+    units.resize(old + len);
+    memcpy(units.data() + old, chars, len * sizeof(ushort));
+}
+
+/** @brief Appends a range of an array (of plain values). */
+template <typename T>
+static void appendArray(QVector<T>& dst, const T* first, const T* last) {
+    int old = dst.size();
+    dst.resize(old + int(last - first));
+    if (last > first) memcpy(dst.data() + old, first, (last - first) * sizeof(T));
+}
+
+/** @brief Latin-1 keys take one code unit per two characters. */
+static int packedLength(int len) {
+    return (len + 1) / 2;
+}
+
+static void putLatin1(QVector<ushort>& units, const QChar* chars, int len) {
+    int old = units.size();
+    units.resize(old + packedLength(len));
+    if (len & 1) units[units.size() - 1] = 0;
+    char* p = reinterpret_cast<char*>(units.data() + old);
+    for (int i = 0; i < len; ++i) p[i] = char(chars[i].unicode());
+}
+
+/** @brief Gets the length of the key of an entry (up to the first `pairDelim`). */
+static int keyLength(const QString& entry) {
+    int delim = entry.indexOf(QChar(pairDelim));
+    return delim < 0 ? entry.size() : delim;
+}
+
+static bool isLatin1(const QChar* chars, int len) {
+    for (int i = 0; i < len; ++i) {
+        if (chars[i].unicode() > 0xff) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Compares `a` with the start of `b` (UTF-16 code units),
+ *        then moves `b` past the units compared if they are equal.
+ */
+template <typename Unit>
+static int compareUnits(const Unit* a, int alen, const QChar*& b, int& blen) {
+    int len = qMin(alen, blen);
+    for (int i = 0; i < len; ++i) {
+        if (a[i] != b[i].unicode()) return a[i] < b[i].unicode() ? -1 : 1;
+    }
+    b += len;
+    blen -= len;
+    return 0;
+}
+
+GramFilter::GramFilter() {
+    memset(bits, 0, sizeof(bits));
+}
+
+void GramFilter::add(const QChar* chars, int len) {
+    for (int i = 0; i < len; ++i) {
+        set(chars[i].unicode());
+        if (i > 0) set((quint32(chars[i - 1].unicode()) << 16) | chars[i].unicode());
+    }
+}
+
+bool GramFilter::covers(const GramFilter& other) const {
+    for (int i = 0; i < gramFilterBits / 64; ++i) {
+        if ((bits[i] & other.bits[i]) != other.bits[i]) return false;
+    }
+    return true;
+}
+
+void GramFilter::set(quint32 gram) {
+    /* Fibonacci hashing: the top bits of the product are well mixed. */
+    quint32 bit = quint32((gram * Q_UINT64_C(0x9E3779B97F4A7C15)) >> 32) % gramFilterBits;
+    bits[bit / 64] |= Q_UINT64_C(1) << (bit % 64);
+}
+
+
+FrontCodedList::Reader::Reader()
+    : list(nullptr), idx(0), block(0), offset(0), latin1(false), stale(false) {}
+
+FrontCodedList::Reader::Reader(const FrontCodedList* list, int idx)
+    : list(list), idx(0), block(0), offset(0), latin1(false), stale(false) {
+    seek(idx);
+}
+
+void FrontCodedList::Reader::seek(int idx) {
+    this->idx = idx;
+    if (atEnd()) return;
+    startBlock(list->blockOf(idx));
+    while (this->idx < idx) next();
+}
+
+void FrontCodedList::Reader::next() {
+    if (++idx >= list->count) return;
+    if (offset >= list->blockOffset[block + 1]) {
+        startBlock(block + 1);
+        return;
+    }
+    const ushort* p = list->units + offset;
+    int shared = getLength(p);
+    if (latin1) key8.truncate(shared);
+    else key16.truncate(shared);
+    readEntry(p, getLength(p));
+}
+
+const QString& FrontCodedList::Reader::value() const {
+    if (stale) {
+        cur.truncate(0);
+        if (latin1) cur.append(QLatin1String(key8.constData(), key8.size()));
+        else cur.append(key16);
+        cur.append(rest);
+        stale = false;
+    }
+    return cur;
+}
+
+void FrontCodedList::Reader::startBlock(int block) {
+    this->block = block;
+    idx = list->blockStart[block];
+    latin1 = list->blockLatin1[block];
+    key8.truncate(0);
+    key16.truncate(0);
+    const ushort* p = list->units + list->blockOffset[block];
+    readEntry(p, getLength(p));
+}
+
+void FrontCodedList::Reader::readEntry(const ushort* p, int keyLen) {
+    if (latin1) {
+        key8.append(reinterpret_cast<const char*>(p), keyLen);
+        p += packedLength(keyLen);
+    } else {
+        key16.append(reinterpret_cast<const QChar*>(p), keyLen);
+        p += keyLen;
+    }
+    int len = getLength(p);
+    rest.truncate(0);
+    rest.append(reinterpret_cast<const QChar*>(p), len);
+    offset = p + len - list->units;
+    stale = true;
+}
+
+FrontCodedList::Storage::Storage() : count(0) {
+    blockOffset.append(0);
+}
+
+
+FrontCodedList::FrontCodedList() : FrontCodedList(std::make_shared<Storage>()) {}
+
+FrontCodedList::FrontCodedList(const QVector<QString>& sorted) : FrontCodedList(encode(sorted)) {}
+
+FrontCodedList::FrontCodedList(const std::shared_ptr<Storage>& storage)
+    : FrontCodedList(
+        storage, storage->units.constData(),
+        storage->blockOffset.constData(), storage->blockStart.constData(),
+        storage->blockLatin1.constData(), storage->blockFilter.constData(),
+        storage->blockStart.size(), storage->count
+    ) {}
+
+FrontCodedList::FrontCodedList(
+    const std::shared_ptr<const void>& owner, const ushort* units,
+    const int* blockOffset, const int* blockStart, const quint8* blockLatin1,
+    const GramFilter* blockFilter, int blocks, int count
+) : owner(owner), units(units), blockOffset(blockOffset), blockStart(blockStart),
+    blockLatin1(blockLatin1), blockFilter(blockFilter), blocks(blocks), count(count) {}
+
+QString FrontCodedList::at(int idx) const {
+    return Reader(this, idx).value();
+}
+
+QVector<QString> FrontCodedList::toList() const {
+    QVector<QString> res;
+    res.reserve(count);
+    for (Reader reader(this, 0); !reader.atEnd(); reader.next())
+        res.append(reader.value());
+    return res;
+}
+
+int FrontCodedList::lowerBound(const QString& key) const {
+    if (count == 0) return 0;
+    int block = blockFor(key);
+    int end = blockEnd(block);
+    Reader reader(this, blockStart[block]);
+    while (reader.index() < end && reader.value() < key) reader.next();
+    return reader.index();
+}
+
+int FrontCodedList::prefixEnd(const QString& prefix, int from) const {
+    if (from >= count) return count;
+    /* The first block after `from` whose first entry does not start with `prefix`. */
+    int lo = blockOf(from) + 1, hi = blocks;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (compareHead(mid, prefix, true) == 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    int end = blockEnd(lo - 1);
+    Reader reader(this, qMax(from, blockStart[lo - 1]));
+    while (reader.index() < end && reader.value().startsWith(prefix)) reader.next();
+    return reader.index();
+}
+
+FrontCodedList FrontCodedList::inserted(int idx, const QString& key) const {
+    if (count == 0) return FrontCodedList(QVector<QString>(1, key));
+    int block = blockOf(qMin(idx, count - 1));
+    QVector<QString> entries = decodeBlock(block);
+    entries.insert(idx - blockStart[block], key);
+    return replacedBlock(block, entries);
+}
+
+FrontCodedList FrontCodedList::removed(int idx) const {
+    int block = blockOf(idx);
+    QVector<QString> entries = decodeBlock(block);
+    entries.remove(idx - blockStart[block]);
+    return replacedBlock(block, entries);
+}
+
+FrontCodedList FrontCodedList::merged(
+    const QVector<QString>& added, const QVector<QString>& removed
+) const {
+    if (count == 0) return FrontCodedList(added);
+
+    std::shared_ptr<Storage> res = std::make_shared<Storage>();
+    res->units.reserve(blockOffset[blocks]);
+    const QString* add = added.constData();
+    const QString* addEnd = add + added.size();
+    const QString* del = removed.constData();
+    const QString* delEnd = del + removed.size();
+    int copied = 0;
+    while (add < addEnd || del < delEnd) {
+        const QString& next = del == delEnd || (add < addEnd && *add < *del) ? *add : *del;
+        int block = blockFor(next);
+        copyBlocks(*res, copied, block);
+
+        /* The changes before the first entry of the next block fall in this one. */
+        const QString* addLast = addEnd;
+        const QString* delLast = delEnd;
+        if (block + 1 < blocks) {
+            for (addLast = add; addLast < addEnd && compareHead(block + 1, *addLast, false) > 0; ++addLast) {}
+            for (delLast = del; delLast < delEnd && compareHead(block + 1, *delLast, false) > 0; ++delLast) {}
+        }
+        QVector<QString> entries = decodeBlock(block), kept, merged;
+        std::set_difference(
+            entries.constBegin(), entries.constEnd(), del, delLast, std::back_inserter(kept)
+        );
+        std::set_union(
+            kept.constBegin(), kept.constEnd(), add, addLast, std::back_inserter(merged)
+        );
+        /* Splits the block once it holds twice the usual entries. */
+        appendBlocks(
+            *res, merged.constData(), merged.constData() + merged.size(),
+            merged.size() > 2 * frontCodingBlock ? frontCodingBlock : merged.size()
+        );
+        add = addLast;
+        del = delLast;
+        copied = block + 1;
+    }
+    copyBlocks(*res, copied, blocks);
+    return FrontCodedList(res);
+}
+
+int FrontCodedList::skipBlocks(const GramFilter& filter, int from, int& end) const {
+    if (from >= count) {
+        end = count;
+        return count;
+    }
+    for (int block = blockOf(from); block < blocks; ++block) {
+        if (blockFilter[block].covers(filter)) {
+            end = blockEnd(block);
+            return qMax(from, blockStart[block]);
+        }
+    }
+    end = count;
+    return count;
+}
+
+qint64 FrontCodedList::bytes() const {
+    return sizeof(*this) + qint64(blockOffset[blocks]) * sizeof(ushort)
+         + qint64(2 * blocks + 1) * sizeof(int)
+         + qint64(blocks) * (sizeof(GramFilter) + sizeof(quint8));
+}
+
+int FrontCodedList::blockOf(int idx) const {
+    return std::upper_bound(blockStart, blockStart + blocks, idx) - blockStart - 1;
+}
+
+int FrontCodedList::blockFor(const QString& key) const {
+    int lo = 0, hi = blocks;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (compareHead(mid, key, false) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return qMax(lo - 1, 0);
+}
+
+int FrontCodedList::compareHead(int block, const QString& key, bool prefix) const {
+    const ushort* p = units + blockOffset[block];
+    const QChar* b = key.constData();
+    int blen = key.size();
+    int keyLen = getLength(p), res;
+    if (blockLatin1[block]) {
+        res = compareUnits(reinterpret_cast<const uchar*>(p), keyLen, b, blen);
+        p += packedLength(keyLen);
+    } else {
+        res = compareUnits(p, keyLen, b, blen);
+        p += keyLen;
+    }
+    if (res != 0) return res;
+    int len = getLength(p);
+    res = compareUnits(p, len, b, blen);
+    if (res != 0) return res;
+
+    len += keyLen;
+    if (len < key.size()) return -1;
+    return prefix || len == key.size() ? 0 : 1;
+}
+
+bool FrontCodedList::isWellFormed() const {
+    for (int block = 0; block < blocks; ++block) {
+        const ushort* p = units + blockOffset[block];
+        const ushort* end = units + blockOffset[block + 1];
+        qint64 prevLen = 0;
+        for (int idx = blockStart[block]; idx < blockEnd(block); ++idx) {
+            /* The key shares a prefix with the previous one (but the first of the block). */
+            int shared = 0, len;
+            if (idx > blockStart[block] && (!getLength(p, end, shared) || shared > prevLen))
+                return false;
+            if (!getLength(p, end, len)) return false;
+            qint64 keyUnits = blockLatin1[block] ? packedLength(len) : len;
+            if (keyUnits > end - p) return false;
+            p += keyUnits;
+            prevLen = qint64(shared) + len;
+            if (prevLen > INT_MAX) return false;
+            if (!getLength(p, end, len) || len > end - p) return false;
+            p += len;
+        }
+        /* Readers move to the next block at its first unit only. */
+        if (p != end) return false;
+    }
+    return true;
+}
+
+QVector<QString> FrontCodedList::decodeBlock(int block) const {
+    QVector<QString> res;
+    int end = blockEnd(block);
+    for (Reader reader(this, blockStart[block]); reader.index() < end; reader.next())
+        res.append(reader.value());
+    return res;
+}
+
+std::shared_ptr<FrontCodedList::Storage> FrontCodedList::encode(const QVector<QString>& sorted) {
+    std::shared_ptr<Storage> storage = std::make_shared<Storage>();
+    appendBlocks(*storage, sorted.constData(), sorted.constData() + sorted.size(), frontCodingBlock);
+    storage->units.squeeze();
+    storage->blockFilter.squeeze();
+    storage->blockLatin1.squeeze();
+    return storage;
+}
+
+void FrontCodedList::appendBlocks(
+    Storage& storage, const QString* first, const QString* last, int blockSize
+) {
+    QVector<ushort>& units = storage.units;
+    while (first < last) {
+        const QString* end = first + qMin<qint64>(blockSize, last - first);
+        storage.blockStart.append(storage.count);
+        GramFilter filter;
+        for (const QString* p = first; p < end; ++p) filter.add(*p);
+        storage.blockFilter.append(filter);
+        /* The keys of the block are stored in 8 bits if they all fit. */
+        bool latin1 = true;
+        for (const QString* p = first; p < end && latin1; ++p)
+            latin1 = isLatin1(p->constData(), keyLength(*p));
+        storage.blockLatin1.append(latin1);
+        int prevLen = 0;
+        for (const QString* p = first; p < end; ++p) {
+            int keyLen = keyLength(*p), shared = 0;
+            if (p > first) {
+                int len = qMin(prevLen, keyLen);
+                while (shared < len && p[-1][shared] == (*p)[shared]) ++shared;
+                putLength(units, shared);
+            }
+            putLength(units, keyLen - shared);
+            if (latin1) putLatin1(units, p->constData() + shared, keyLen - shared);
+            else putChars(units, p->constData() + shared, keyLen - shared);
+            putLength(units, p->size() - keyLen);
+            putChars(units, p->constData() + keyLen, p->size() - keyLen);
+            prevLen = keyLen;
+        }
+        storage.blockOffset.append(units.size());
+        storage.count += end - first;
+        first = end;
+    }
+}
+
+void FrontCodedList::copyBlocks(Storage& storage, int first, int last) const {
+    if (first >= last) return;
+    int offsetDelta = storage.units.size() - blockOffset[first];
+    int countDelta = storage.count - blockStart[first];
+    appendArray(storage.units, units + blockOffset[first], units + blockOffset[last]);
+    appendArray(storage.blockFilter, blockFilter + first, blockFilter + last);
+    appendArray(storage.blockLatin1, blockLatin1 + first, blockLatin1 + last);
+    for (int i = first; i < last; ++i) {
+        storage.blockStart.append(blockStart[i] + countDelta);
+        storage.blockOffset.append(blockOffset[i + 1] + offsetDelta);
+    }
+    storage.count += blockEnd(last - 1) - blockStart[first];
+}
+
+FrontCodedList FrontCodedList::replacedBlock(int block, const QVector<QString>& entries) const {
+    std::shared_ptr<Storage> res = std::make_shared<Storage>();
+    copyBlocks(*res, 0, block);
+    /* Splits the block once it holds twice the usual entries. */
+    appendBlocks(
+        *res, entries.constData(), entries.constData() + entries.size(),
+        entries.size() > 2 * frontCodingBlock ? frontCodingBlock : entries.size()
+    );
+    /* The following blocks are moved as they are. */
+    copyBlocks(*res, block + 1, blocks);
+    return FrontCodedList(res);
+}
@@ -0,0 +1,98 @@
+#include <QtCore/QDeadlineTimer>
+#include <QtGui/QPainter>
+#include <QtGui/QPixmapCache>
+#include <QtWidgets/QApplication>
+
+#include "glyphDelegate.h"
+
+/** @brief Gets the color of the text of an item. */
+static QColor textColor(const QStyleOptionViewItem& opt) {
+    return opt.palette.color(
+        opt.state & QStyle::State_Enabled ? QPalette::Normal : QPalette::Disabled,
+        opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text
+    );
+}
+
+GlyphDelegate::GlyphDelegate(QAbstractItemView* view)
+    : QStyledItemDelegate(view), view(view) {
+    /* The cache is shared with the style: only ever enlarged. */
+    if (QPixmapCache::cacheLimit() < glyphCacheKB)
+        QPixmapCache::setCacheLimit(glyphCacheKB);
+    warmTimer = new QTimer(this);
+    warmTimer->setInterval(0);
+    connect(warmTimer, SIGNAL(timeout()), this, SLOT(warm_next()));
+}
+
+void GlyphDelegate::paint(
+    QPainter* painter, const QStyleOptionViewItem& option,
+    const QModelIndex& index
+) const {
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    if (opt.text.isEmpty()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+    const QWidget* widget = opt.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+    qreal dpr = painter->device()->devicePixelRatioF();
+    QPixmap pixmap = glyphs(opt.text, opt.font, textColor(opt), dpr);
+    QSize size = pixmap.size() / dpr;
+    if (size.width() > textRect.width()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    /* The cell without its text, then the text blitted. */
+    opt.text.clear();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+    painter->drawPixmap(
+        QStyle::alignedRect(opt.direction, opt.displayAlignment, size, textRect),
+        pixmap
+    );
+}
+
+void GlyphDelegate::warm(const QStringList& texts) {
+    foreach (const QString& text, texts) {
+        if (pending.size() >= maxWarmGlyphs) break;
+        if (!text.isEmpty()) pending.enqueue(text);
+    }
+    if (!pending.isEmpty()) warmTimer->start();
+}
+
+void GlyphDelegate::cancelWarming() {
+    pending.clear();
+    warmTimer->stop();
+}
+
+void GlyphDelegate::warm_next() {
+    QStyleOptionViewItem opt;
+    opt.initFrom(view);
+    QColor color = textColor(opt);
+    qreal dpr = view->devicePixelRatioF();
+    QDeadlineTimer deadline(frameBudget);
+    while (!pending.isEmpty() && !deadline.hasExpired())
+        glyphs(pending.dequeue(), view->font(), color, dpr);
+    if (pending.isEmpty()) warmTimer->stop();
+}
+
+QPixmap GlyphDelegate::glyphs(const QString& text, const QFont& font, const QColor& color, qreal dpr) {
+    QString key = QString("glyph:%1:%2:%3:%4")
+                    .arg(font.key()).arg(color.rgba()).arg(dpr).arg(text);
+    QPixmap res;
+    if (QPixmapCache::find(key, &res)) return res;
+
+    QFontMetrics metrics(font);
+    QSize size(qMax(metrics.horizontalAdvance(text), 1), metrics.height());
+    res = QPixmap(size * dpr);
+    res.setDevicePixelRatio(dpr);
+    res.fill(Qt::transparent);
+    QPainter painter(&res);
+    painter.setFont(font);
+    painter.setPen(color);
+    painter.drawText(QRect(QPoint(0, 0), size), Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, text);
+    painter.end();
+    QPixmapCache::insert(key, res);
+    return res;
+}
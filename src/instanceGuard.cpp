@@ -0,0 +1,99 @@
+#include <QtCore/QDataStream>
+#include <QtCore/QFileInfo>
+
+#include "instanceGuard.h"
+#include "logger.h"
+
+InstanceGuard::InstanceGuard(QObject* parent)
+    : QObject(parent), server(nullptr) {
+
+}
+
+InstanceGuard::~InstanceGuard() {
+
+}
+
+QString InstanceGuard::serverName() {
+    QString user = QString::fromLocal8Bit(qgetenv("USER"));
+    if (user.isEmpty()) user = QString::fromLocal8Bit(qgetenv("USERNAME"));
+    return QString("%1-%2").arg(projectName).arg(user);
+}
+
+bool InstanceGuard::notifyRunning(const QStringList& args) {
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(connectTimeout)) return false;
+
+    /* The running instance may have another working directory. */
+    QStringList absArgs = args;
+    for (int i = 1; i < absArgs.length(); ++i) {
+        if (!absArgs[i].startsWith("--"))
+            absArgs[i] = QFileInfo(absArgs[i]).absoluteFilePath();
+    }
+    QByteArray message;
+    QDataStream out(&message, QIODevice::WriteOnly);
+    out << absArgs;
+    socket.write(message);
+    /* Flushes the arguments before closing. */
+    socket.disconnectFromServer();
+    if (socket.state() != QLocalSocket::UnconnectedState
+        && !socket.waitForDisconnected(connectTimeout)) {
+        stdLogger.Warning("Failed to activate the running instance.");
+        return false;
+    }
+    stdLogger.Debug("Arguments handed over to the running instance.");
+    return true;
+}
+
+bool InstanceGuard::listen() {
+    if (isListening()) return true;
+    if (server == nullptr) {
+        server = new QLocalServer(this);
+        server->setSocketOptions(QLocalServer::UserAccessOption);
+        connect(server, SIGNAL(newConnection()), this, SLOT(on_new_connection()));
+    }
+    if (server->listen(serverName())) return true;
+
+    /* Left behind by an instance which crashed (nobody answered above). */
+    QLocalServer::removeServer(serverName());
+    if (server->listen(serverName())) return true;
+
+    stdLogger.Warning(
+        QString("Failed to listen on %1: %2")
+        .arg(serverName()).arg(server->errorString()).toStdString().c_str()
+    );
+    return false;
+}
+
+void InstanceGuard::close() {
+    if (server != nullptr) server->close();
+}
+
+bool InstanceGuard::isListening() const {
+    return server != nullptr && server->isListening();
+}
+
+void InstanceGuard::on_new_connection() {
+    while (QLocalSocket* socket = server->nextPendingConnection()) {
+        connect(socket, SIGNAL(readyRead()), this, SLOT(read_arguments()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        /* The arguments may have arrived with the connection. */
+        readArguments(socket);
+    }
+}
+
+void InstanceGuard::read_arguments() {
+    QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+    if (socket != nullptr) readArguments(socket);
+}
+
+void InstanceGuard::readArguments(QLocalSocket* socket) {
+    QStringList args;
+    QDataStream in(socket);
+    /* Waits for the whole message. */
+    in.startTransaction();
+    in >> args;
+    if (!in.commitTransaction()) return;
+
+    emit activated(args);
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QThread>
+#include <QtGui/QKeyEvent>
+
+#include "fileHandler.h"
+#include "keystrokeReplay.h"
+
+/** @brief Gets the statistics (ms) of some latencies (ns). */
+static QString summarize(QVector<qint64> samples) {
+    if (samples.isEmpty()) return QString("none");
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    foreach (qint64 sample, samples) sum += sample;
+    auto percentile = [&samples](double p) {
+        return samples[qMin(samples.size() - 1, int(p * samples.size()))] / 1e6;
+    };
+    return QString("n %1, mean %2, p50 %3, p90 %4, p99 %5, max %6")
+           .arg(samples.size()).arg(sum / samples.size() / 1e6, 0, 'f', 3)
+           .arg(percentile(0.5), 0, 'f', 3).arg(percentile(0.9), 0, 'f', 3)
+           .arg(percentile(0.99), 0, 'f', 3).arg(samples.last() / 1e6, 0, 'f', 3);
+}
+
+/** @brief Formats a latency (ns) of the report. */
+static QString latency(qint64 nsecs) {
+    return nsecs < 0 ? QString("-") : QString::number(nsecs / 1e6, 'f', 3);
+}
+
+KeystrokeReplay::KeystrokeReplay(mainWindow* win, QObject* parent)
+    : QObject(parent), win(win), shownAt(-1), filledAt(-1) {
+    deadline = new QTimer(this);
+    deadline->setSingleShot(true);
+    deadline->setInterval(replayTimeout);
+    connect(deadline, SIGNAL(timeout()), &loop, SLOT(quit()));
+    connect(
+        win, SIGNAL(tableUpdated(const QString&, bool)),
+        this, SLOT(table_updated(const QString&, bool))
+    );
+}
+
+bool KeystrokeReplay::parse(const QString& contents, QVector<Event>& events, QString& error) {
+    QStringList lines = contents.split('\n');
+    for (int i = 0; i < lines.length(); ++i) {
+        /* The arguments are kept as they are: spaces can be typed. */
+        QString line = lines[i];
+        if (line.endsWith('\r')) line.chop(1);
+        if (line.trimmed().isEmpty() || line.trimmed().startsWith('#')) continue;
+
+        int sp = line.indexOf(' ');
+        QString command = line.mid(0, sp), arg = sp < 0 ? QString() : line.mid(sp + 1);
+        Event event;
+        bool ok = true;
+        if (command == "type" && !arg.isEmpty()) {
+            event.kind = Event::Type;
+            foreach (const QChar& ch, arg) {
+                event.text = ch;
+                events.append(event);
+            }
+        } else if (command == "backspace") {
+            int count = arg.isEmpty() ? 1 : arg.toInt(&ok);
+            event.kind = Event::Backspace;
+            for (int j = 0; ok && j < count; ++j) events.append(event);
+        } else if (command == "paste" && !arg.isEmpty()) {
+            event.kind = Event::Paste;
+            event.text = arg;
+            events.append(event);
+        } else if (command == "clear" && arg.isEmpty()) {
+            event.kind = Event::Clear;
+            events.append(event);
+        } else if (command == "wait") {
+            event.kind = Event::Wait;
+            event.text = arg;
+            ok = arg.toInt() > 0;
+            if (ok) events.append(event);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = QString("line %1: invalid event: %2").arg(i + 1).arg(line);
+            return false;
+        }
+    }
+    return true;
+}
+
+void KeystrokeReplay::replay(const QVector<Event>& events, QTextStream& out) {
+    static const char* kindNames[] = { "type", "backspace", "paste", "clear", "wait" };
+    QVector<qint64> shown, filled;
+    int timeouts = 0;
+
+    out << "# event\tinput\thint\trows\tshown (ms)\tfilled (ms)" << "\n";
+    timer.start();
+    for (int i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        if (event.kind == Event::Wait) {
+            QTimer::singleShot(event.text.toInt(), &loop, SLOT(quit()));
+            loop.exec();
+            continue;
+        }
+
+        QString before = win->hintEdit->text();
+        shownAt = filledAt = -1;
+        qint64 sentAt = timer.nsecsElapsed();
+        send(event);
+        /* Cheap queries are run before `send` returns. */
+        bool changed = win->hintEdit->text() != before;
+        if (changed && filledAt < 0) {
+            deadline->start();
+            loop.exec();
+            deadline->stop();
+        }
+
+        if (changed) {
+            if (shownAt >= 0) shown.append(shownAt - sentAt);
+            if (filledAt >= 0) filled.append(filledAt - sentAt);
+            else ++timeouts;
+        }
+        out << i + 1 << "\t" << kindNames[event.kind]
+            << (event.kind == Event::Type || event.kind == Event::Paste ? " " + event.text : QString())
+            << "\t" << win->hintEdit->text()
+            /* The last row is kept blank. */
+            << "\t" << qMax(win->targetTable->rowCount() - 1, 0)
+            << "\t" << latency(shownAt < 0 ? -1 : shownAt - sentAt)
+            << "\t" << latency(filledAt < 0 ? -1 : filledAt - sentAt) << "\n";
+    }
+    out << "# shown (ms): " << summarize(shown) << "\n";
+    out << "# filled (ms): " << summarize(filled) << "\n";
+    out << "# timeouts: " << timeouts << ", total: "
+        << QString::number(timer.nsecsElapsed() / 1e6, 'f', 3) << " ms" << "\n";
+}
+
+void KeystrokeReplay::table_updated(const QString& hint, bool complete) {
+    /* The results of an earlier hint, shown late: the hint only changes on `send`. */
+    if (hint != win->hintEdit->text()) return;
+    if (shownAt < 0) shownAt = timer.nsecsElapsed();
+    if (complete) {
+        filledAt = timer.nsecsElapsed();
+        loop.quit();
+    }
+}
+
+void KeystrokeReplay::send(const Event& event) {
+    QLineEdit* hintEdit = win->hintEdit;
+    switch (event.kind) {
+    case Event::Type: {
+        QChar ch = event.text[0];
+        QKeyEvent press(QEvent::KeyPress, ch.toUpper().unicode(), Qt::NoModifier, event.text);
+        QKeyEvent release(QEvent::KeyRelease, ch.toUpper().unicode(), Qt::NoModifier, event.text);
+        QCoreApplication::sendEvent(hintEdit, &press);
+        QCoreApplication::sendEvent(hintEdit, &release);
+        break;
+    }
+    case Event::Backspace: {
+        QKeyEvent press(QEvent::KeyPress, Qt::Key_Backspace, Qt::NoModifier);
+        QKeyEvent release(QEvent::KeyRelease, Qt::Key_Backspace, Qt::NoModifier);
+        QCoreApplication::sendEvent(hintEdit, &press);
+        QCoreApplication::sendEvent(hintEdit, &release);
+        break;
+    }
+    case Event::Paste:
+        /* Not through the clipboard, which is the user's one on a real display. */
+        hintEdit->insert(event.text);
+        break;
+    case Event::Clear:
+        hintEdit->clear();
+        break;
+    case Event::Wait:
+        break;
+    }
+}
+
+int KeystrokeReplay::run(const QStringList& args) {
+    QTextStream err(stderr);
+    int idx = args.indexOf(replayOption);
+    if (idx < 0 || idx + 2 >= args.length()) {
+        err << "Usage: " << replayOption << " <trace> <dictionary>" << "\n";
+        return 1;
+    }
+    QString traceFile = args[idx + 1], dictionary = args[idx + 2];
+
+    QString contents, error;
+    QVector<Event> events;
+    if (!FileHandler::readText(traceFile, contents)) {
+        err << "Failed to read: " << traceFile << "\n";
+        return 1;
+    }
+    if (!parse(contents, events, error)) {
+        err << traceFile << ": " << error << "\n";
+        return 1;
+    }
+    if (!QFileInfo(dictionary).isReadable()) {
+        err << "Failed to read: " << dictionary << "\n";
+        return 1;
+    }
+
+    mainWindow win(nullptr, dictionary);
+    win.show();
+    /* The dictionary is loaded and ordered before the first keystroke. */
+    QElapsedTimer timer;
+    timer.start();
+    while (!win.isIndexed() && timer.elapsed() < replayTimeout) {
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    if (!win.isIndexed()) {
+        err << "Failed to load: " << dictionary << "\n";
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    out << "# " << projectName << " replay of " << traceFile
+        << " (" << events.size() << " events) on " << dictionary << "\n";
+    KeystrokeReplay replay(&win);
+    replay.replay(events, out);
+    return 0;
+}
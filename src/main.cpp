@@ -1,10 +1,31 @@
+#include <string.h>
+
 #include <QtCore/QTextCodec>
 #include <QtWidgets/QApplication>
 
+#include "instanceGuard.h"
+#include "keystrokeReplay.h"
 #include "mainWindow.h"
+#include "queryClient.h"
 
 
 int main(int argc, char* argv[]) {
+    /* Command line client of the running instance: no GUI. */
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], queryOption) == 0 || strcmp(argv[i], benchOption) == 0) {
+            QCoreApplication app(argc, argv);
+            return QueryClient::run(app.arguments());
+        }
+    }
+
+    /* Replays run on the offscreen platform, unless another one is asked for. */
+    bool replay = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], replayOption) == 0) replay = true;
+    }
+    if (replay && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
     QGuiApplication::setHighDpiScaleFactorRoundingPolicy(
@@ -15,8 +36,15 @@ int main(int argc, char* argv[]) {
         QTextCodec::codecForName("UTF-8")
     );
 
+    if (replay) return KeystrokeReplay::run(app.arguments());
+
+    /* Re-shows the resident instance (with its warm engine) instead. */
+    if (InstanceGuard::notifyRunning(app.arguments())) return 0;
+
     mainWindow win;
-    win.show();
+    if (app.arguments().contains(residentOption)) win.setResident(true);
+    if (app.arguments().contains(serveOption)) win.setServing(true);
+    win.activate_instance(app.arguments());
 
     return app.exec();
 }
@@ -1,14 +1,32 @@
+#include <QtCore/QFutureWatcher>
+
+#include "allocStats.h"
 #include "mainWindow.h"
 
 
-mainWindow::mainWindow(QWidget* parent)
+mainWindow::mainWindow(QWidget* parent, const QString& dictionary)
     : QMainWindow(parent) {
 
     stdLogger.Debug("Loading utilities...");
     
     clipboard = QApplication::clipboard();
-    fHandler = new FileHandler;
-    searchEngine = new SearchEngine;
+    packs = new PackManager;
+    personalPack = packs->addPack(personalPackName, dictionary, true);
+    scratch = dictionary != builtinConfig;
+    fHandler = packs->pack(personalPack).handler;
+    searchEngine = packs->pack(personalPack).engine;
+    dictWatcher = new DictWatcher(this);
+
+    scheduler = new QueryScheduler(this);
+
+    instanceGuard = new InstanceGuard(this);
+    resident = false;
+    queryService = new QueryService(packs, this);
+
+    queryCost = 0;
+    filledRows = 0;
+    fillTimer = new QTimer(this);
+    fillTimer->setInterval(0);
 
     hDialog = new helpDialog(this);
     
@@ -25,16 +43,86 @@ mainWindow::mainWindow(QWidget* parent)
     popup->show();
     initAnimation();
     seqGroup->start();
+
+    /* Loads the packs once the window is shown. */
+    QTimer::singleShot(0, this, SLOT(preload_packs()));
 }
 
 mainWindow::~mainWindow() {
     stdLogger.Debug("Saving configurations...");
     writeSettings();
-    delete searchEngine;
-    delete fHandler;
+    QueryCache::Stats stats = packs->cacheStats();
+    stdLogger.Debug(
+        QString("Query cache: %1 hits, %2 misses, %3 evictions, %4 invalidations.")
+        .arg(stats.hits).arg(stats.misses).arg(stats.evictions).arg(stats.invalidations)
+        .toStdString().c_str()
+    );
+    /* Its batches in flight read the engines. */
+    delete queryService;
+    delete packs;
     stdLogger.Debug("Program exited normally.");
 }
 
+void mainWindow::setResident(bool on) {
+    QSignalBlocker blocker(residentAction);
+    if (on && !instanceGuard->listen()) on = false;
+    if (!on) instanceGuard->close();
+    resident = on;
+    residentAction->setChecked(on);
+}
+
+void mainWindow::setServing(bool on) {
+    QSignalBlocker blocker(serveAction);
+    if (on) on = queryService->listen();
+    else queryService->close();
+    serveAction->setChecked(on);
+}
+
+void mainWindow::activate_instance(const QStringList& args) {
+    /* args[0] is the program. */
+    for (int i = 1; i < args.length(); ++i) {
+        if (args[i].startsWith("--")) continue;
+        if (!load(args[i])) {
+            stdLogger.Warning(
+                QString("Failed to load: %1").arg(args[i]).toStdString().c_str()
+            );
+            continue;
+        }
+        dictWatcher->watch(args[i]);
+        statusBar()->showMessage(QString("Dictionary imported: %1").arg(args[i]), 2000);
+    }
+    show();
+    raise();
+    activateWindow();
+    hintEdit->setFocus();
+    hintEdit->selectAll();
+}
+
+void mainWindow::toggle_resident(bool on) {
+    setResident(on);
+    statusBar()->showMessage(
+        resident ? QString("%1 keeps running in the background.").arg(projectName)
+           : QString("%1 exits after copying.").arg(projectName),
+        2000
+    );
+}
+
+void mainWindow::toggle_serving(bool on) {
+    setServing(on);
+    statusBar()->showMessage(
+        queryService->isListening()
+            ? QString("Serving queries on %1").arg(QueryService::serverName())
+            : QString("Query service stopped."),
+        2000
+    );
+}
+
+void mainWindow::hide_window() {
+    /* Nothing is saved on exit while resident: saves it now. */
+    writeSettings();
+    hide();
+}
+
 void mainWindow::import_dict() {
     QString fn = QFileDialog::getOpenFileName(
         this, "Import from...", ".", fileFilter
@@ -50,6 +138,7 @@ void mainWindow::import_dict() {
         );
         return;
     }
+    dictWatcher->watch(fn);
     stdLogger.Debug(msg.toStdString().c_str());
     statusBar()->showMessage(msg, 2000);
 }
@@ -73,7 +162,38 @@ void mainWindow::export_dict() {
     statusBar()->showMessage(msg, 2000);
 }
 
+void mainWindow::reload_dict(
+    const QString& fn, const QStringList& added, const QStringList& removed
+) {
+    QString key, value;
+    strList addedEntries, removedEntries;
+    packs->ensureLoaded(personalPack);
+    QStringList unprovided;
+    foreach (const QString& line, removed) {
+        if (!dictWatcher->providedElsewhere(line, fn)) unprovided.append(line);
+    }
+    foreach (const QString& line, fHandler->removeLines(unprovided)) {
+        FileHandler::parseLine(line, key, value);
+        removedEntries.append(key + pairDelim + value);
+    }
+    foreach (const QString& line, added) {
+        if (!fHandler->addLine(line)) continue;
+        FileHandler::parseLine(line, key, value);
+        addedEntries.append(key + pairDelim + value);
+    }
+    /* Published at once: queries see all or none of the changes. */
+    refreshWhenDone(searchEngine->update(addedEntries, removedEntries));
+
+    QString msg = QString("Dictionary reloaded: %1 (+%2, -%3)")
+                    .arg(fn).arg(added.length()).arg(removed.length());
+    stdLogger.Debug(msg.toStdString().c_str());
+    statusBar()->showMessage(msg, 2000);
+}
+
 bool mainWindow::load(const QString& fn) {
+    ALLOC_SCOPE("mainWindow::load");
+    /* Merges into the personal dictionary. */
+    packs->ensureLoaded(personalPack);
     if (!fHandler->loadFromText(fn)) {
         stdLogger.Warning(
             QString(
@@ -82,47 +202,112 @@ bool mainWindow::load(const QString& fn) {
         );
         return false;
     }
-    QString key, value;
-    while (fHandler->getWordPair(key, value)) {
-        searchEngine->add(key + pairDelim + value);
-    }
+    strList entries;
+    fHandler->takeEntries(entries);
+    searchEngine->load(entries);
     return true;
 }
 
 bool mainWindow::save(const QString& fn) {
+    if (!packs->ensureLoaded(personalPack)) return false;
     return fHandler->saveAsText(fn);
 }
 
 void mainWindow::updateTable() {
+    ALLOC_BUDGET("mainWindow::updateTable", allocBudget(hintEdit->text()));
+    /* Abandon the results of the previous hint. */
+    fillTimer->stop();
     clearTableContentItems();
-    QTableWidgetItem* item;
 
-    strQueue res = searchEngine->findRelative(hintEdit->text());
-    int realSize = res.length(), delimIdx;
-    QString hint, target, tmp;
-    targetTable->setRowCount(realSize);
-    targetTable->insertRow(realSize);
-    for (int i = 0; i < realSize; ++i) {
-        tmp = res.deQueue();
+    /* Shows the first screen right now, and the rest in `fill_table`. */
+    strQueue res;
+    cursorHint = hintEdit->text();
+    searchCursor = packs->search(cursorHint);
+    searchCursor.fetch(res, visibleRowCount(), QDeadlineTimer(frameBudget));
+    appendTableRows(res);
+    ALLOC_ALLOW(quint64(res.length()) * (resultAllocBudget + rowAllocBudget));
+    if (!searchCursor.atEnd()) fillTimer->start();
+    else packs->prefetch(hintEdit->text());
+    emit tableUpdated(cursorHint, searchCursor.atEnd());
+}
+
+void mainWindow::fill_table() {
+    ALLOC_BUDGET("mainWindow::fill_table", allocBudget(cursorHint));
+    QElapsedTimer timer;
+    timer.start();
+    QDeadlineTimer deadline(frameBudget);
+    strQueue res;
+    while (!searchCursor.atEnd() && !deadline.hasExpired()) {
+        searchCursor.fetch(res, fillChunk, deadline);
+        appendTableRows(res);
+        ALLOC_ALLOW(quint64(res.length()) * (resultAllocBudget + rowAllocBudget));
+        res.clear();
+    }
+    queryCost += timer.elapsed();
+    if (searchCursor.atEnd()) {
+        fillTimer->stop();
+        scheduler->reportCost(queryCost);
+        /* Idle until the next keystroke: the likely next queries are run ahead. */
+        packs->prefetch(hintEdit->text());
+        emit tableUpdated(cursorHint, true);
+    }
+}
+
+void mainWindow::appendTableRows(const strQueue& rows) {
+    QTableWidgetItem* item;
+    int delimIdx, i = filledRows;
+    QString hint, target;
+    QStringList targets;
+    /* Keeps a blank row at the end. */
+    targetTable->setRowCount(filledRows + rows.length() + 1);
+    for (const QString& tmp : rows) {
         delimIdx = tmp.indexOf(pairDelim);
         hint = tmp.mid(0, delimIdx);
         target = tmp.mid(delimIdx + 1);
         item = new QTableWidgetItem(hint);
         targetTable->setItem(i, 0, item);
         item = new QTableWidgetItem(target);
-        targetTable->setItem(i, 1, item);
+        targetTable->setItem(i++, 1, item);
+        targets.append(target);
     }
+    filledRows = i;
+    /* Rendered before they are scrolled to. */
+    glyphDelegate->warm(targets);
 }
 
 void mainWindow::clearTableContentItems() {
     /* Release all the nodes itself. */
-    while (targetTable->rowCount() > 0) {
-        targetTable->removeRow(0);
-    }
+    glyphDelegate->cancelWarming();
+    targetTable->setRowCount(0);
+    filledRows = 0;
+}
+
+int mainWindow::visibleRowCount() const {
+    int rowHeight = targetTable->verticalHeader()->defaultSectionSize();
+    return targetTable->viewport()->height() / qMax(rowHeight, 1) + 1;
+}
+
+quint64 mainWindow::allocBudget(const QString& pattern) const {
+    /* No limit on the patterns (see `SearchEngine::findRelative`). */
+    if (PatternQuery::isPattern(pattern)) return 0;
+    /* Each pack reads a chunk of results ahead of the rows merged. */
+    return quint64(packs->count()) * (queryAllocBudget + fillChunk * resultAllocBudget);
 }
 
 void mainWindow::on_hintEdit_textChanged(const QString& text) {
+    packs->cancelPrefetch();
+    scheduler->submit(text);
+}
+
+void mainWindow::run_query(const QString& pattern) {
+    /* The previous query is abandoned: reports what it cost so far. */
+    if (fillTimer->isActive()) scheduler->reportCost(queryCost);
+
+    QElapsedTimer timer;
+    timer.start();
     updateTable();
+    queryCost = timer.elapsed();
+    if (searchCursor.atEnd()) scheduler->reportCost(queryCost);
 }
 
 void mainWindow::on_targetTable_itemClicked(QTableWidgetItem* item) {
@@ -135,7 +320,8 @@ void mainWindow::on_targetTable_itemClicked(QTableWidgetItem* item) {
 
 void mainWindow::on_targetTable_itemDoubleClicked(QTableWidgetItem* item) {
     on_targetTable_itemClicked(item);
-    QTimer::singleShot(100, this, SLOT(close()));
+    if (resident) QTimer::singleShot(100, this, SLOT(hide_window()));
+    else QTimer::singleShot(100, this, SLOT(close()));
 }
 
 void mainWindow::initAppearance() {
@@ -156,6 +342,8 @@ void mainWindow::initAppearance() {
     targetTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     targetTable->horizontalHeader()->setMinimumSectionSize(150);
     targetTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    glyphDelegate = new GlyphDelegate(targetTable);
+    targetTable->setItemDelegateForColumn(1, glyphDelegate);
 }
 
 void mainWindow::initAnimation() {
@@ -188,11 +376,34 @@ void mainWindow::createActions() {
     exportAction->setStatusTip(tr("Export the dictionary to a text file."));
     connect(exportAction, SIGNAL(triggered()), this, SLOT(export_dict()));
 
+    connect(fillTimer, SIGNAL(timeout()), this, SLOT(fill_table()));
+    connect(
+        scheduler, SIGNAL(queryReady(const QString&)),
+        this, SLOT(run_query(const QString&))
+    );
+
+    connect(
+        dictWatcher,
+        SIGNAL(sourceChanged(const QString&, const QStringList&, const QStringList&)),
+        this,
+        SLOT(reload_dict(const QString&, const QStringList&, const QStringList&))
+    );
+
     exitAction->setIcon(QIcon(":/exit.png"));
     exitAction->setShortcut(QKeySequence::Quit);
     exitAction->setStatusTip(tr("Quit the application"));
     connect(exitAction, SIGNAL(triggered()), qApp, SLOT(quit()));
 
+    residentAction->setStatusTip(tr("Keep running in the background after copying."));
+    connect(residentAction, SIGNAL(toggled(bool)), this, SLOT(toggle_resident(bool)));
+
+    serveAction->setStatusTip(tr("Answer the symbol queries of other local programs."));
+    connect(serveAction, SIGNAL(toggled(bool)), this, SLOT(toggle_serving(bool)));
+    connect(
+        instanceGuard, SIGNAL(activated(const QStringList&)),
+        this, SLOT(activate_instance(const QStringList&))
+    );
+
     // connect(helpMenu, SIGNAL(aboutToShow()), this, SLOT(help()));
     helpAction->setIcon(QIcon(":/help.png"));
     helpAction->setShortcut(QKeySequence::HelpContents);
@@ -224,15 +435,102 @@ void mainWindow::loadStyleSheet() {
 }
 
 void mainWindow::writeSettings() {
+    if (scratch) return;
     QSettings settings("SJTU-XHW Inc.", projectName);
     settings.setValue("geometry", saveGeometry());
-    save(builtinConfig);
+    settings.setValue("watchedSources", dictWatcher->sources());
+    /* The baselines of the next run: edits made meanwhile are applied then. */
+    QVariantMap watchedLines;
+    foreach (const QString& fn, dictWatcher->sources())
+        watchedLines.insert(fn, dictWatcher->linesOf(fn));
+    settings.setValue("watchedLines", watchedLines);
+    settings.setValue("enabledPacks", packs->enabledNames());
+    settings.setValue("resident", resident);
+    settings.setValue("queryService", queryService->isListening());
+    /* Untouched if it has never been loaded. */
+    if (packs->pack(personalPack).loaded)
+        save(builtinConfig);
 }
 
 void mainWindow::loadSettings() {
+    if (scratch) {
+        /* Only the given dictionary: the runs are reproducible. */
+        createPackActions();
+        return;
+    }
     QSettings settings("SJTU-XHW Inc.", projectName);
     restoreGeometry(settings.value("geometry").toByteArray());
-    load(builtinConfig);
+    packs->setCacheCapacity(settings.value("cacheBytes", defaultCacheBytes).toLongLong());
+    /* Packs are only registered here: they are loaded by the first query. */
+    packs->scan(packDir);
+    foreach (const QString& name, settings.value("enabledPacks").toStringList()) {
+        int idx = packs->indexOf(name);
+        if (idx >= 0) packs->setEnabled(idx, true);
+    }
+    createPackActions();
+    /* Entries of the watched files are already in `builtinConfig`, as they were last seen. */
+    QVariantMap watchedLines = settings.value("watchedLines").toMap();
+    foreach (const QString& fn, settings.value("watchedSources").toStringList()) {
+        if (watchedLines.contains(fn))
+            dictWatcher->watch(fn, watchedLines.value(fn).toStringList());
+        else
+            dictWatcher->watch(fn);
+    }
+    setResident(settings.value("resident", false).toBool());
+    setServing(settings.value("queryService", false).toBool());
+}
+
+void mainWindow::createPackActions() {
+    QAction* action;
+    for (int i = 0; i < packs->count(); ++i) {
+        if (i == personalPack) continue;
+        action = menu_Packs->addAction(packs->pack(i).name);
+        action->setCheckable(true);
+        action->setChecked(packs->pack(i).enabled);
+        action->setData(i);
+        action->setStatusTip(
+            tr("Search in %1").arg(packs->pack(i).filename)
+        );
+    }
+    menu_Packs->setEnabled(!menu_Packs->isEmpty());
+    connect(menu_Packs, SIGNAL(triggered(QAction*)), this, SLOT(toggle_pack(QAction*)));
+}
+
+void mainWindow::loadPack(int idx) {
+    packs->ensureLoaded(idx);
+    if (packs->pack(idx).loading.isFinished()) return;
+    refreshWhenDone(packs->pack(idx).loading);
+}
+
+void mainWindow::refreshWhenDone(const QFuture<void>& future) {
+    /* A future finished already is reported as soon as it is watched. */
+    QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(entries_published()));
+    connect(watcher, SIGNAL(finished()), watcher, SLOT(deleteLater()));
+    watcher->setFuture(future);
+}
+
+void mainWindow::preload_packs() {
+    for (int i = 0; i < packs->count(); ++i) {
+        if (packs->pack(i).enabled) loadPack(i);
+    }
+}
+
+void mainWindow::entries_published() {
+    /* The entries read or merged meanwhile were missing from the results. */
+    updateTable();
+}
+
+void mainWindow::toggle_pack(QAction* action) {
+    int idx = action->data().toInt();
+    packs->setEnabled(idx, action->isChecked());
+    if (action->isChecked()) loadPack(idx);
+    updateTable();
+
+    QString msg = QString("Pack %1: %2")
+                    .arg(action->isChecked() ? "enabled" : "disabled")
+                    .arg(packs->pack(idx).name);
+    statusBar()->showMessage(msg, 2000);
 }
 
 void mainWindow::help() {
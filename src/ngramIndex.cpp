@@ -0,0 +1,42 @@
+#include <algorithm>
+
+#include "ngramIndex.h"
+
+NgramIndex::NgramIndex(const FrontCodedList& list) {
+    for (FrontCodedList::Reader reader(&list, 0); !reader.atEnd(); reader.next()) {
+        const QString& entry = reader.value();
+        for (int i = 0; i + gram <= entry.length(); ++i) {
+            QVector<int>& posting = postings[keyOf(entry.constData() + i)];
+            /* Once per entry. */
+            if (posting.isEmpty() || posting.last() != reader.index())
+                posting.append(reader.index());
+        }
+    }
+    for (QVector<int>& posting : postings) posting.squeeze();
+}
+
+bool NgramIndex::candidates(const QStringList& literals, QVector<int>& candidates) const {
+    QVector<const QVector<int>*> lists;
+    static const QVector<int> none;
+    foreach (const QString& literal, literals) {
+        for (int i = 0; i + gram <= literal.length(); ++i) {
+            QHash<quint64, QVector<int>>::const_iterator iter = postings.find(keyOf(literal.constData() + i));
+            lists.append(iter == postings.end() ? &none : &iter.value());
+        }
+    }
+    if (lists.isEmpty()) return false;
+
+    /* Intersects from the shortest posting. */
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+        return a->size() < b->size();
+    });
+    candidates = *lists[0];
+    for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i)
+        intersectPostings(candidates, *lists[i]);
+    return true;
+}
+
+quint64 NgramIndex::keyOf(const QChar* chars) {
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16)
+         | chars[2].unicode();
+}
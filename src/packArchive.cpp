@@ -0,0 +1,109 @@
+#include <limits.h>
+
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QDataStream>
+#include <QtCore/QtEndian>
+
+#include "packArchive.h"
+
+/* "ESZP" */
+static const quint32 archiveMagic = 0x45535a50;
+static const quint32 archiveFormat = 1;
+/* The magic, the format & the number of chunks. */
+static const int archiveHeader = 3 * sizeof(quint32);
+/* The packed & raw sizes of a chunk. */
+static const int chunkEntry = 2 * sizeof(quint32);
+
+/** @brief Compresses the text of a chunk (on a worker thread). */
+static QByteArray deflateChunk(const QByteArray& text) {
+    return qCompress(text, packCompressionLevel);
+}
+
+bool PackArchive::isArchive(const QByteArray& bytes) {
+    if (bytes.size() < int(sizeof(quint32))) return false;
+    quint32 magic;
+    QDataStream in(bytes);
+    in >> magic;
+    return magic == archiveMagic;
+}
+
+QByteArray PackArchive::pack(const QStringList& lines) {
+    QVector<QByteArray> texts;
+    QByteArray text;
+    foreach (const QString& line, lines) {
+        text.append(line.toUtf8());
+        text.append('\n');
+        /* Cut at line boundaries: every chunk parses on its own. */
+        if (text.size() >= packChunkBytes) {
+            texts.append(text);
+            text.clear();
+        }
+    }
+    if (!text.isEmpty()) texts.append(text);
+
+    QVector<QFuture<QByteArray>> packed;
+    packed.reserve(texts.size());
+    foreach (const QByteArray& chunk, texts)
+        packed.append(QtConcurrent::run(deflateChunk, chunk));
+
+    QByteArray res;
+    QDataStream out(&res, QIODevice::WriteOnly);
+    out << archiveMagic << archiveFormat << quint32(texts.size());
+    for (int i = 0; i < texts.size(); ++i)
+        out << quint32(packed[i].result().size()) << quint32(texts[i].size());
+    for (int i = 0; i < texts.size(); ++i) {
+        const QByteArray data = packed[i].result();
+        out.writeRawData(data.constData(), data.size());
+    }
+    return res;
+}
+
+bool PackArchive::index(const QByteArray& archive, QVector<PackChunk>& chunks) {
+    QDataStream in(archive);
+    quint32 magic, format, count;
+    in >> magic >> format >> count;
+    if (in.status() != QDataStream::Ok || magic != archiveMagic || format != archiveFormat)
+        return false;
+    if (count > quint32(archive.size() - archiveHeader) / chunkEntry) return false;
+
+    qint64 offset = archiveHeader + qint64(count) * chunkEntry;
+    chunks.clear();
+    chunks.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        quint32 packedSize, rawSize;
+        in >> packedSize >> rawSize;
+        if (in.status() != QDataStream::Ok || offset + packedSize > archive.size()
+            || rawSize > quint32(INT_MAX))
+            return false;
+        PackChunk chunk;
+        chunk.offset = int(offset);
+        chunk.packedSize = int(packedSize);
+        chunk.rawSize = int(rawSize);
+        chunks.append(chunk);
+        offset += packedSize;
+    }
+    return offset == archive.size();
+}
+
+QByteArray PackArchive::inflate(const QByteArray& archive, const PackChunk& chunk) {
+    const uchar* data = reinterpret_cast<const uchar*>(archive.constData()) + chunk.offset;
+    /* `qCompress` leads with the raw size: a corrupted one is not allocated. */
+    if (chunk.packedSize < int(sizeof(quint32))
+        || qFromBigEndian<quint32>(data) != quint32(chunk.rawSize))
+        return QByteArray();
+    QByteArray text = qUncompress(data, chunk.packedSize);
+    if (text.size() != chunk.rawSize) return QByteArray();
+    return text;
+}
+
+bool PackArchive::unpack(const QByteArray& archive, QByteArray& text) {
+    QVector<PackChunk> chunks;
+    if (!index(archive, chunks)) return false;
+    text.clear();
+    foreach (const PackChunk& chunk, chunks) {
+        QByteArray part = inflate(archive, chunk);
+        if (part.isNull() && chunk.rawSize > 0) return false;
+        text.append(part);
+    }
+    return true;
+}
@@ -0,0 +1,292 @@
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QDir>
+
+#include "packManager.h"
+#include "sharedIndex.h"
+
+PackCursor::PackCursor()
+    : pass(SearchCursor::FuzzyPass), collated(false), unordered(false), done(true) {}
+
+PackCursor::PackCursor(const QVector<const SearchEngine*>& engines, const QString& pattern)
+    : engines(engines), pat(pattern), done(false) {
+    startPass(SearchCursor::PrefixPass);
+}
+
+void PackCursor::startPass(int pass) {
+    this->pass = pass;
+    /* Pattern queries yield both passes in code-unit order. */
+    collated = pass == SearchCursor::PrefixPass && !PatternQuery::isPattern(pat);
+    unordered = false;
+    yielded.clear();
+    cursors.clear();
+    buffers.clear();
+    headKeys.clear();
+    foreach (const SearchEngine* engine, engines) {
+        cursors.append(engine->search(pat, pass));
+        buffers.append(strQueue());
+        headKeys.append(QByteArray());
+        if (!cursors.last().isOrdered()) unordered = true;
+    }
+}
+
+int PackCursor::fetch(strQueue& out, int maxCount, QDeadlineTimer deadline) {
+    int count = 0, best;
+    while (!done && count < maxCount) {
+        /* Picks the smallest head among the engines. */
+        best = -1;
+        for (int i = 0; i < cursors.size(); ++i) {
+            if (buffers[i].isempty() && !cursors[i].atEnd()) {
+                cursors[i].fetch(buffers[i], fillChunk, deadline);
+                refreshHead(i);
+                /* The order is unknown until every engine has a head. */
+                if (buffers[i].isempty() && !cursors[i].atEnd()) return count;
+            }
+            if (buffers[i].isempty()) continue;
+            if (best < 0 || precedes(i, best)) best = i;
+        }
+
+        if (best < 0) {
+            if (pass == SearchCursor::PrefixPass) startPass(SearchCursor::FuzzyPass);
+            else done = true;
+            continue;
+        }
+        QString entry = buffers[best].deQueue();
+        refreshHead(best);
+        /* Provided by more than one pack. */
+        if (entry == last) continue;
+        if (unordered) {
+            if (yielded.contains(entry)) continue;
+            yielded.insert(entry);
+        }
+        out.enQueue(entry);
+        last = entry;
+        ++count;
+    }
+    return count;
+}
+
+void PackCursor::refreshHead(int idx) {
+    /* Computed once per head, rather than on each comparison. */
+    if (collated && !buffers[idx].isempty())
+        headKeys[idx] = CollationIndex::sortKey(buffers[idx].getHead());
+    else
+        headKeys[idx].clear();
+}
+
+bool PackCursor::precedes(int a, int b) const {
+    const QString& aHead = buffers[a].getHead();
+    const QString& bHead = buffers[b].getHead();
+    if (!collated) return aHead < bHead;
+    /* The order of `SearchCursor`: sort keys first, then code units. */
+    if (headKeys[a] != headKeys[b]) return headKeys[a] < headKeys[b];
+    return aHead < bHead;
+}
+
+
+/**
+ * @brief Loads a shared pack into its engine (on a worker thread).
+ * 
+ * Its index is mapped if it is up to date. Otherwise the file is parsed,
+ * and its index is published once the entries are ordered.
+ * 
+ * @return FALSE if the file cannot be read (the engine is left empty).
+ */
+static bool loadShared(SearchEngine* engine, const QString& name, const QString& filename) {
+    const QString indexPath = SharedIndex::indexPath(filename);
+    FrontCodedList list;
+    std::shared_ptr<const CollationIndex> collation;
+    if (SharedIndex::attach(indexPath, SharedIndex::versionOf(filename), list, collation)) {
+        engine->loadIndexed(list, collation);
+        stdLogger.Debug(
+            QString("Pack attached: %1 (%2 entries)")
+            .arg(name).arg(list.size()).toStdString().c_str()
+        );
+        return true;
+    }
+    /* Stat before reading: a file changed meanwhile leaves a stale (rejected) index. */
+    const SharedIndex::Version source = SharedIndex::versionOf(filename);
+    FileHandler handler;
+    if (!handler.loadFromText(filename)) {
+        stdLogger.Warning(
+            QString("Failed to load pack: %1 (%2).")
+            .arg(name).arg(filename).toStdString().c_str()
+        );
+        return false;
+    }
+    strList entries;
+    handler.takeEntries(entries);
+    /* Queryable now, ordered in the background. */
+    engine->load(entries, [name, indexPath, source](const EngineSnapshot& built) {
+        if (!SharedIndex::publish(indexPath, source, built.srcList, *built.collationIndex())) {
+            stdLogger.Warning(
+                QString("Failed to publish the index of pack: %1 (%2).")
+                .arg(name).arg(indexPath).toStdString().c_str()
+            );
+        }
+    });
+    stdLogger.Debug(
+        QString("Pack loaded: %1 (%2 entries)")
+        .arg(name).arg(engine->size()).toStdString().c_str()
+    );
+    return true;
+}
+
+
+PackManager::PackManager() : cacheBytes(defaultCacheBytes) {
+
+}
+
+PackManager::~PackManager() {
+    for (DictPack& pack : packs) {
+        pack.loading.waitForFinished();
+        delete pack.engine;
+        delete pack.handler;
+    }
+}
+
+int PackManager::addPack(
+    const QString& name, const QString& filename, bool enabled, bool shared
+) {
+    DictPack pack;
+    pack.name = name;
+    pack.filename = filename;
+    pack.enabled = enabled;
+    pack.loaded = false;
+    pack.shared = shared;
+    pack.handler = new FileHandler;
+    pack.engine = new SearchEngine;
+    pack.engine->setCacheCapacity(cacheBytes);
+    packs.append(pack);
+    return packs.size() - 1;
+}
+
+int PackManager::scan(const QString& dirname) {
+    QDir dir(dirname);
+    QStringList patterns;
+    patterns << "*.txt" << "*." packArchiveSuffix;
+    int res = 0;
+    foreach (const QFileInfo& info, dir.entryInfoList(patterns, QDir::Files, QDir::Name)) {
+        if (indexOf(info.completeBaseName()) >= 0) continue;
+        addPack(info.completeBaseName(), info.filePath(), false, true);
+        ++res;
+    }
+    return res;
+}
+
+int PackManager::indexOf(const QString& name) const {
+    for (int i = 0; i < packs.size(); ++i) {
+        if (packs[i].name == name) return i;
+    }
+    return -1;
+}
+
+QStringList PackManager::enabledNames() const {
+    QStringList res;
+    for (const DictPack& pack : packs) {
+        if (pack.enabled) res.append(pack.name);
+    }
+    return res;
+}
+
+void PackManager::setEnabled(int idx, bool enabled) {
+    DictPack& pack = packs[idx];
+    pack.enabled = enabled;
+    if (!enabled && pack.loaded) {
+        /* Otherwise it would publish the entries after they are cleared. */
+        pack.loading.waitForFinished();
+        pack.engine->clear();
+        pack.handler->clearCache();
+        pack.loaded = false;
+        stdLogger.Debug(
+            QString("Pack unloaded: %1").arg(pack.name).toStdString().c_str()
+        );
+    }
+}
+
+bool PackManager::ensureLoaded(int idx) {
+    DictPack& pack = packs[idx];
+    /* A failed read is retried. */
+    if (pack.loaded && pack.shared && pack.loading.isFinished() && !pack.loading.result())
+        pack.loaded = false;
+    if (pack.loaded) return true;
+    if (pack.shared) {
+        pack.loading = QtConcurrent::run(loadShared, pack.engine, pack.name, pack.filename);
+        pack.loaded = true;
+        return true;
+    }
+
+    if (!pack.handler->loadFromText(pack.filename)) {
+        stdLogger.Warning(
+            QString("Failed to load pack: %1 (%2).")
+            .arg(pack.name).arg(pack.filename).toStdString().c_str()
+        );
+        return false;
+    }
+    strList entries;
+    pack.handler->takeEntries(entries);
+    /* Queryable now, ordered in the background. */
+    pack.engine->load(entries);
+    pack.loaded = true;
+    stdLogger.Debug(
+        QString("Pack loaded: %1 (%2 entries)")
+        .arg(pack.name).arg(pack.engine->size()).toStdString().c_str()
+    );
+    return true;
+}
+
+PackCursor PackManager::search(const QString& pattern) {
+    return PackCursor(enabledEngines(), pattern);
+}
+
+QVector<const SearchEngine*> PackManager::enabledEngines() {
+    QVector<const SearchEngine*> engines;
+    for (int i = 0; i < packs.size(); ++i) {
+        if (packs[i].enabled && ensureLoaded(i))
+            engines.append(packs[i].engine);
+    }
+    return engines;
+}
+
+bool PackManager::isIndexed() const {
+    for (const DictPack& pack : packs) {
+        if (!pack.enabled) continue;
+        if (!pack.loaded || !pack.loading.isFinished() || !pack.engine->isIndexed()) return false;
+        if (pack.shared && !pack.loading.result()) return false;
+    }
+    return true;
+}
+
+void PackManager::prefetch(const QString& pattern) {
+    /* The queries of a `PackCursor`: one per pass. */
+    QVector<int> passes;
+    passes.append(SearchCursor::PrefixPass);
+    passes.append(SearchCursor::FuzzyPass);
+    for (DictPack& pack : packs) {
+        if (pack.enabled && pack.loaded) pack.engine->prefetch(pattern, passes);
+    }
+}
+
+void PackManager::cancelPrefetch() {
+    for (DictPack& pack : packs) pack.engine->cancelPrefetch();
+}
+
+void PackManager::setCacheCapacity(qint64 capacity) {
+    cacheBytes = capacity;
+    for (DictPack& pack : packs) pack.engine->setCacheCapacity(capacity);
+}
+
+QueryCache::Stats PackManager::cacheStats() const {
+    QueryCache::Stats res;
+    res.hits = res.misses = res.evictions = res.invalidations = res.bytes = 0;
+    res.entries = 0;
+    for (const DictPack& pack : packs) {
+        QueryCache::Stats cur = pack.engine->cacheStats();
+        res.hits += cur.hits;
+        res.misses += cur.misses;
+        res.evictions += cur.evictions;
+        res.invalidations += cur.invalidations;
+        res.bytes += cur.bytes;
+        res.entries += cur.entries;
+    }
+    return res;
+}
@@ -0,0 +1,141 @@
+#include <string.h>
+
+#include "patternQuery.h"
+
+/* The escapes of one character: classes (`\d`...), assertions (`\b`...) & controls (`\t`...). */
+static const char oneCharEscapes[] = "dDwWsSbBhHvVRAzZGtnrfea";
+
+bool PatternQuery::isPattern(const QString& hint) {
+    if (hint.length() > 1 && hint[0] == regexPrefix) return true;
+    /* A lone wildcard is looked up as a symbol. */
+    return hint.length() > 1 && (hint.contains('*') || hint.contains('?'));
+}
+
+PatternQuery::PatternQuery(const QString& hint) {
+    QString regex;
+    if (hint[0] == regexPrefix) {
+        regex = hint.mid(1);
+        literals = regexLiterals(regex);
+    } else {
+        QString literal;
+        foreach (QChar c, hint) {
+            if (c == '*' || c == '?') {
+                regex += c == '*' ? ".*" : ".";
+                if (!literal.isEmpty()) literals.append(literal);
+                literal.clear();
+            } else {
+                regex += QRegularExpression::escape(QString(c));
+                literal += c;
+            }
+        }
+        if (!literal.isEmpty()) literals.append(literal);
+    }
+    unanchored.setPattern(regex);
+    anchored.setPattern(QString("\\A(?:%1)").arg(regex));
+    unanchored.optimize();
+    anchored.optimize();
+}
+
+bool PatternQuery::matchesPrefix(const QString& entry) const {
+    return anchored.match(entry).hasMatch();
+}
+
+bool PatternQuery::matches(const QString& entry) const {
+    return unanchored.match(entry).hasMatch();
+}
+
+bool PatternQuery::isAlive(const QString& prefix) const {
+    QRegularExpressionMatch match = anchored.match(
+        prefix, 0, QRegularExpression::PartialPreferCompleteMatch
+    );
+    return match.hasMatch() || match.hasPartialMatch();
+}
+
+int PatternQuery::deadPrefix(const QString& entry) const {
+    if (isAlive(entry)) return -1;
+    /* Dead past some length: the shortest dead prefix skips the most entries. */
+    int lo = 0, hi = entry.length();
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (isAlive(entry.left(mid))) lo = mid;
+        else hi = mid;
+    }
+    return hi;
+}
+
+/**
+ * @brief Finds the end of the class opened at `start`.
+ * 
+ * A `]` right after `[` or `[^` is a member, so are the POSIX classes (`[:alpha:]`).
+ * 
+ * @return The position of its `]` (the length of `regex` if unclosed).
+ */
+static int classEnd(const QString& regex, int start) {
+    int i = start + 1;
+    if (i < regex.length() && regex[i] == '^') ++i;
+    if (i < regex.length() && regex[i] == ']') ++i;
+    for (; i < regex.length(); ++i) {
+        if (regex[i] == '\\') {
+            ++i;
+        } else if (regex[i] == '[' && i + 1 < regex.length() && regex[i + 1] == ':') {
+            int close = regex.indexOf(":]", i + 2);
+            if (close >= 0) i = close + 1;
+        } else if (regex[i] == ']') {
+            return i;
+        }
+    }
+    return regex.length();
+}
+
+QStringList PatternQuery::regexLiterals(const QString& regex) {
+    QStringList res;
+    /* Any literal may be skipped by an alternative, or matched by another case. */
+    if (regex.contains('|') || regex.contains("(?")) return res;
+    /* Quoted text is not parsed: `\Q...\E`. */
+    if (regex.contains("\\Q")) return res;
+
+    QString literal;
+    auto flush = [&res, &literal]() {
+        if (!literal.isEmpty()) res.append(literal);
+        literal.clear();
+    };
+    for (int i = 0; i < regex.length(); ++i) {
+        QChar c = regex[i];
+        if (c == '\\' && i + 1 < regex.length() && !regex[i + 1].isLetterOrNumber()) {
+            literal += regex[++i];
+        } else if (c == '\\') {
+            /* `\d`, `\w`...: the escapes spanning more characters
+               (`\x41`, `\p{L}`, `\g{1}`, `\0nn`...) are not parsed. */
+            if (i + 1 < regex.length()
+                && (regex[i + 1].unicode() > 0x7f || !strchr(oneCharEscapes, regex[i + 1].toLatin1())))
+                return QStringList();
+            flush();
+            ++i;
+        } else if (c == '*' || c == '?' || c == '{') {
+            /* The last character may be absent. */
+            literal.chop(1);
+            flush();
+            if (c == '{') i = regex.indexOf('}', i) < 0 ? regex.length() : regex.indexOf('}', i);
+        } else if (c == '[') {
+            /* Classes are not looked into. */
+            flush();
+            i = classEnd(regex, i);
+        } else if (c == '(') {
+            /* Nor are groups. */
+            flush();
+            int depth = 0;
+            for (; i < regex.length(); ++i) {
+                if (regex[i] == '\\') ++i;
+                else if (regex[i] == '[') i = classEnd(regex, i);
+                else if (regex[i] == '(') ++depth;
+                else if (regex[i] == ')' && --depth == 0) break;
+            }
+        } else if (c == '.' || c == '^' || c == '$' || c == '+' || c == ')' || c == ']') {
+            flush();
+        } else {
+            literal += c;
+        }
+    }
+    flush();
+    return res;
+}
@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "postings.h"
+
+/**
+ * @brief Finds the first position from `from` whose entry is not less than `value`.
+ * 
+ * Probes 1, 2, 4... entries ahead, then binary searches the last step.
+ */
+static int gallop(const postingList& list, int from, int value) {
+    int step = 1, hi = from;
+    while (hi < list.size() && list[hi] < value) {
+        from = hi + 1;
+        hi += step;
+        step <<= 1;
+    }
+    hi = qMin(hi, list.size());
+    return std::lower_bound(list.begin() + from, list.begin() + hi, value) - list.begin();
+}
+
+void intersectPostings(postingList& res, const postingList& other) {
+    int kept = 0, pos = 0;
+    for (int i = 0; i < res.size() && pos < other.size(); ++i) {
+        pos = gallop(other, pos, res[i]);
+        if (pos < other.size() && other[pos] == res[i]) res[kept++] = res[i];
+    }
+    res.resize(kept);
+}
+
+void intersectUnion(postingList& res, const QVector<const postingList*>& lists) {
+    QVector<int> pos(lists.size(), 0);
+    int kept = 0;
+    for (int i = 0; i < res.size(); ++i) {
+        for (int j = 0; j < lists.size(); ++j) {
+            pos[j] = gallop(*lists[j], pos[j], res[i]);
+            if (pos[j] < lists[j]->size() && lists[j]->at(pos[j]) == res[i]) {
+                res[kept++] = res[i];
+                break;
+            }
+        }
+    }
+    res.resize(kept);
+}
+
+postingList unitePostings(const QVector<const postingList*>& lists) {
+    if (lists.size() == 1) return *lists[0];
+    postingList res;
+    for (const postingList* list : lists) res += *list;
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+}
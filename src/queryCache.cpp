@@ -0,0 +1,147 @@
+#include <QtCore/QStringList>
+
+#include "queryCache.h"
+
+/** @brief Rough bookkeeping cost of an entry (node, hash slot, allocations). */
+static constexpr qint64 nodeOverhead = 96;
+/** @brief Rough cost of a result besides its characters (handle, string header, allocation). */
+static constexpr qint64 resultOverhead = qint64(sizeof(QString)) + 32;
+
+/** @brief Gets the memory held by results: decoded entries are owned by the cache alone. */
+static qint64 resultBytes(const QVector<QString>& results) {
+    qint64 res = 0;
+    foreach (const QString& result, results) res += resultOverhead + 2 * (result.size() + 1);
+    return res;
+}
+
+QueryCache::QueryCache(qint64 capacity) : capacity(capacity), curVersion(0) {
+    counters.hits = counters.misses = 0;
+    counters.evictions = counters.invalidations = 0;
+    counters.bytes = 0;
+    counters.entries = 0;
+}
+
+QueryCache::~QueryCache() {
+
+}
+
+QString QueryCache::keyOf(const QString& pattern, int passes) {
+    return QString::number(passes) + pairDelim + pattern;
+}
+
+void QueryCache::setCapacity(qint64 capacity) {
+    QMutexLocker locker(&lock);
+    this->capacity = capacity;
+    shrink();
+}
+
+int QueryCache::maxResults() const {
+    QMutexLocker locker(&lock);
+    /* A single query may not take more than 1/8 of the cache. */
+    return int(capacity / 8 / resultOverhead);
+}
+
+bool QueryCache::lookup(const QString& pattern, int passes, QVector<QString>& results) {
+    QMutexLocker locker(&lock);
+    QHash<QString, nodeIter>::iterator iter = index.find(keyOf(pattern, passes));
+    if (iter == index.end()) {
+        ++counters.misses;
+        return false;
+    }
+    /* Moves it to the front as the most recently used. */
+    nodes.splice(nodes.begin(), nodes, iter.value());
+    results = iter.value()->results;
+    ++counters.hits;
+    return true;
+}
+
+bool QueryCache::contains(const QString& pattern, int passes) const {
+    QMutexLocker locker(&lock);
+    return index.contains(keyOf(pattern, passes));
+}
+
+void QueryCache::insert(
+    const QString& pattern, int passes, const QVector<QString>& results, int version
+) {
+    QMutexLocker locker(&lock);
+    if (version != curVersion) return;
+
+    QString key = keyOf(pattern, passes);
+    QHash<QString, nodeIter>::iterator iter = index.find(key);
+    if (iter != index.end()) drop(iter.value());
+
+    Node node;
+    node.pattern = pattern;
+    node.passes = passes;
+    node.results = results;
+    node.bytes = nodeOverhead + 2 * (key.size() + pattern.size()) + resultBytes(results);
+    if (node.bytes > capacity / 8) return;
+
+    nodes.push_front(node);
+    index.insert(key, nodes.begin());
+    counters.bytes += node.bytes;
+    ++counters.entries;
+    shrink();
+}
+
+/** @brief Check if `entry` contains every one of `terms`. */
+static bool containsAll(const QString& entry, const QStringList& terms) {
+    foreach (const QString& term, terms) {
+        if (!entry.contains(term)) return false;
+    }
+    return true;
+}
+
+void QueryCache::invalidate(const QVector<QString>& entries) {
+    QMutexLocker locker(&lock);
+    ++curVersion;
+    nodeIter node = nodes.begin();
+    while (node != nodes.end()) {
+        nodeIter next = node;
+        ++next;
+        /* Multi-term queries match the entries containing all their terms. */
+        QStringList terms = node->pattern.simplified().split(' ');
+        foreach (const QString& entry, entries) {
+            if (containsAll(entry, terms)) {
+                drop(node);
+                ++counters.invalidations;
+                break;
+            }
+        }
+        node = next;
+    }
+}
+
+void QueryCache::invalidateAll() {
+    QMutexLocker locker(&lock);
+    ++curVersion;
+    counters.invalidations += counters.entries;
+    nodes.clear();
+    index.clear();
+    counters.bytes = 0;
+    counters.entries = 0;
+}
+
+int QueryCache::version() const {
+    QMutexLocker locker(&lock);
+    return curVersion;
+}
+
+QueryCache::Stats QueryCache::stats() const {
+    QMutexLocker locker(&lock);
+    return counters;
+}
+
+void QueryCache::drop(nodeIter node) {
+    index.remove(keyOf(node->pattern, node->passes));
+    counters.bytes -= node->bytes;
+    --counters.entries;
+    nodes.erase(node);
+}
+
+void QueryCache::shrink() {
+    while (counters.bytes > capacity && !nodes.empty()) {
+        drop(--nodes.end());
+        ++counters.evictions;
+    }
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+
+#include <QtCore/QElapsedTimer>
+
+#include "fileHandler.h"
+#include "queryClient.h"
+#include "queryService.h"
+
+/** @brief Results asked for each pattern of the command line. */
+static const int cliResults = 20;
+/** @brief Default number of queries in a batch of the benchmark. */
+static const int benchBatch = 16;
+
+QueryClient::QueryClient() {
+
+}
+
+QueryClient::~QueryClient() {
+
+}
+
+bool QueryClient::connectToService(int msecs) {
+    socket.connectToServer(QueryService::serverName());
+    return socket.waitForConnected(msecs);
+}
+
+bool QueryClient::send(const QVector<ServiceQuery>& batch) {
+    QByteArray frame = QueryProtocol::encodeRequest(batch);
+    return socket.write(frame) == frame.size();
+}
+
+bool QueryClient::receive(QVector<ServiceReply>& replies, int msecs) {
+    QByteArray payload;
+    int res;
+    while ((res = QueryProtocol::takeFrame(&socket, payload, maxReplyFrame)) == 0) {
+        /* Writes the pending requests too. */
+        if (!socket.waitForReadyRead(msecs)) return false;
+    }
+    return res > 0 && QueryProtocol::decodeReply(payload, replies);
+}
+
+int QueryClient::run(const QStringList& args) {
+    QTextStream err(stderr);
+    QueryClient client;
+    if (!client.connectToService()) {
+        err << "No running instance serves queries (launch it with "
+            << serveOption << ")." << "\n";
+        return 1;
+    }
+
+    int idx = args.indexOf(queryOption);
+    if (idx >= 0) return query(client, args.mid(idx + 1));
+
+    idx = args.indexOf(benchOption);
+    if (idx + 1 >= args.length()) {
+        err << "Usage: " << benchOption << " <file> [batch size]" << "\n";
+        return 1;
+    }
+    int batchSize = benchBatch;
+    if (idx + 2 < args.length()) batchSize = qBound(1, args[idx + 2].toInt(), maxBatchQueries);
+    return bench(client, args[idx + 1], batchSize);
+}
+
+int QueryClient::query(QueryClient& client, const QStringList& patterns) {
+    QTextStream out(stdout);
+    QVector<ServiceQuery> batch;
+    for (int i = 0; i < patterns.length() && i < maxBatchQueries; ++i) {
+        ServiceQuery query;
+        query.id = i;
+        query.maxResults = cliResults;
+        query.pattern = patterns[i];
+        batch.append(query);
+    }
+
+    QVector<ServiceReply> replies;
+    if (!client.send(batch) || !client.receive(replies)) {
+        QTextStream(stderr) << "The query service stopped answering." << "\n";
+        return 1;
+    }
+    foreach (const ServiceReply& reply, replies) {
+        if (reply.id >= quint32(batch.size())) continue;
+        out << "# " << patterns[reply.id] << "\n";
+        foreach (const QString& item, reply.results) out << item << "\n";
+    }
+    return 0;
+}
+
+int QueryClient::bench(QueryClient& client, const QString& filename, int batchSize) {
+    QTextStream out(stdout);
+    QString contents;
+    if (!FileHandler::readText(filename, contents)) {
+        QTextStream(stderr) << "Failed to read: " << filename << "\n";
+        return 1;
+    }
+    QStringList patterns = FileHandler::splitLines(contents);
+    if (patterns.isEmpty()) return 0;
+
+    QVector<QVector<ServiceQuery>> batches;
+    for (int i = 0; i < patterns.length(); i += batchSize) {
+        QVector<ServiceQuery> batch;
+        for (int j = i; j < patterns.length() && j < i + batchSize; ++j) {
+            ServiceQuery query;
+            query.id = j;
+            query.maxResults = maxQueryResults;
+            query.pattern = patterns[j];
+            batch.append(query);
+        }
+        batches.append(batch);
+    }
+
+    /* Keeps as many batches in flight as the service takes from a client. */
+    QVector<qint64> sentAt(batches.size()), latency;
+    QVector<ServiceReply> replies;
+    qint64 results = 0;
+    int sent = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int recv = 0; recv < batches.size(); ++recv) {
+        while (sent < batches.size() && sent - recv < maxClientBatches) {
+            sentAt[sent] = timer.nsecsElapsed();
+            client.send(batches[sent++]);
+        }
+        if (!client.receive(replies)) {
+            QTextStream(stderr) << "The query service stopped answering." << "\n";
+            return 1;
+        }
+        latency.append(timer.nsecsElapsed() - sentAt[recv]);
+        foreach (const ServiceReply& reply, replies) results += reply.results.size();
+    }
+    double secs = timer.nsecsElapsed() / 1e9;
+
+    std::sort(latency.begin(), latency.end());
+    auto percentile = [&latency](double p) {
+        return latency[qMin(latency.size() - 1, int(p * latency.size()))] / 1e6;
+    };
+    out << QString("%1 queries in %2 batches of %3, %4 results")
+           .arg(patterns.length()).arg(batches.size()).arg(batchSize).arg(results) << "\n";
+    out << QString("throughput: %1 queries/s").arg(patterns.length() / secs, 0, 'f', 1) << "\n";
+    out << QString("batch latency (ms): p50 %1, p90 %2, p99 %3, max %4")
+           .arg(percentile(0.5), 0, 'f', 3).arg(percentile(0.9), 0, 'f', 3)
+           .arg(percentile(0.99), 0, 'f', 3).arg(latency.last() / 1e6, 0, 'f', 3) << "\n";
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <QtCore/QDataStream>
+
+#include "queryProtocol.h"
+
+static void writeString(QDataStream& out, const QString& str) {
+    QByteArray bytes = str.toUtf8();
+    /* Symbols are short: longer ones are truncated. */
+    if (bytes.size() > 0xffff) bytes.truncate(0xffff);
+    out << quint16(bytes.size());
+    out.writeRawData(bytes.constData(), bytes.size());
+}
+
+static bool readString(QDataStream& in, QString& str) {
+    quint16 len;
+    in >> len;
+    if (in.status() != QDataStream::Ok) return false;
+    QByteArray bytes(len, Qt::Uninitialized);
+    if (in.readRawData(bytes.data(), len) != len) return false;
+    str = QString::fromUtf8(bytes);
+    return true;
+}
+
+/** @brief Prefixes the payload with its length. */
+static QByteArray frame(const QByteArray& payload) {
+    QByteArray res;
+    QDataStream out(&res, QIODevice::WriteOnly);
+    out << quint32(payload.size());
+    out.writeRawData(payload.constData(), payload.size());
+    return res;
+}
+
+
+QByteArray QueryProtocol::encodeRequest(const QVector<ServiceQuery>& batch) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << quint16(batch.size());
+    for (const ServiceQuery& query : batch) {
+        out << query.id << query.maxResults;
+        writeString(out, query.pattern);
+    }
+    return frame(payload);
+}
+
+bool QueryProtocol::decodeRequest(const QByteArray& payload, QVector<ServiceQuery>& batch) {
+    QDataStream in(payload);
+    quint16 count;
+    in >> count;
+    if (count > maxBatchQueries) return false;
+    batch.resize(count);
+    for (ServiceQuery& query : batch) {
+        in >> query.id >> query.maxResults;
+        if (!readString(in, query.pattern)) return false;
+    }
+    return in.status() == QDataStream::Ok && in.atEnd();
+}
+
+QByteArray QueryProtocol::encodeReply(const QVector<ServiceReply>& replies) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << quint16(replies.size());
+    for (const ServiceReply& reply : replies) {
+        out << reply.id << quint32(reply.results.size());
+        foreach (const QString& item, reply.results) writeString(out, item);
+    }
+    return frame(payload);
+}
+
+bool QueryProtocol::decodeReply(const QByteArray& payload, QVector<ServiceReply>& replies) {
+    QDataStream in(payload);
+    quint16 count;
+    quint32 n;
+    QString item;
+    in >> count;
+    replies.resize(count);
+    for (ServiceReply& reply : replies) {
+        in >> reply.id >> n;
+        if (in.status() != QDataStream::Ok) return false;
+        reply.results.clear();
+        for (quint32 i = 0; i < n; ++i) {
+            if (!readString(in, item)) return false;
+            reply.results.append(item);
+        }
+    }
+    return in.status() == QDataStream::Ok && in.atEnd();
+}
+
+int QueryProtocol::takeFrame(QIODevice* device, QByteArray& payload, int maxSize) {
+    QByteArray header = device->peek(sizeof(quint32));
+    if (header.size() < int(sizeof(quint32))) return 0;
+
+    quint32 len;
+    QDataStream(header) >> len;
+    if (len > quint32(maxSize)) return -1;
+    if (device->bytesAvailable() < qint64(sizeof(quint32) + len)) return 0;
+
+    device->read(sizeof(quint32));
+    payload = device->read(len);
+    return 1;
+}
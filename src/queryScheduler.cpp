@@ -0,0 +1,38 @@
+#include "queryScheduler.h"
+
+/** @brief Weight of the latest cost in the moving average. */
+static constexpr double costWeight = 0.3;
+
+QueryScheduler::QueryScheduler(QObject* parent)
+    : QObject(parent) {
+    avgCost = 0;
+    delayTimer = new QTimer(this);
+    delayTimer->setSingleShot(true);
+    connect(delayTimer, SIGNAL(timeout()), this, SLOT(run_pending()));
+}
+
+QueryScheduler::~QueryScheduler() {
+
+}
+
+void QueryScheduler::submit(const QString& pattern) {
+    pending = pattern;
+    if (avgCost <= cheapQueryCost && !delayTimer->isActive()) {
+        run_pending();
+        return;
+    }
+
+    if (!delayTimer->isActive()) pendingSince.start();
+    int delay = qMin(int(avgCost * 2), maxDebounce);
+    int remaining = maxDebounce - int(pendingSince.elapsed());
+    delayTimer->start(qBound(0, delay, qMax(remaining, 0)));
+}
+
+void QueryScheduler::reportCost(qint64 msecs) {
+    avgCost = (1 - costWeight) * avgCost + costWeight * msecs;
+}
+
+void QueryScheduler::run_pending() {
+    delayTimer->stop();
+    emit queryReady(pending);
+}
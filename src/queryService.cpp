@@ -0,0 +1,146 @@
+#include <QtConcurrent/QtConcurrent>
+
+#include "instanceGuard.h"
+#include "logger.h"
+#include "queryService.h"
+
+QueryService::QueryService(PackManager* packs, QObject* parent)
+    : QObject(parent), packs(packs), server(nullptr), nextClient(0) {
+
+}
+
+QueryService::~QueryService() {
+    close();
+    pool.waitForDone();
+}
+
+QString QueryService::serverName() {
+    return InstanceGuard::serverName() + "-query";
+}
+
+bool QueryService::listen() {
+    if (isListening()) return true;
+    if (server == nullptr) {
+        server = new QLocalServer(this);
+        server->setSocketOptions(QLocalServer::UserAccessOption);
+        connect(server, SIGNAL(newConnection()), this, SLOT(on_new_connection()));
+    }
+    if (!server->listen(serverName())) {
+        QLocalSocket probe;
+        probe.connectToServer(serverName());
+        if (probe.waitForConnected(connectTimeout)) {
+            stdLogger.Warning("Queries are served by another instance already.");
+            return false;
+        }
+        /* Left behind by an instance which crashed. */
+        QLocalServer::removeServer(serverName());
+        if (!server->listen(serverName())) {
+            stdLogger.Warning(
+                QString("Failed to listen on %1: %2")
+                .arg(serverName()).arg(server->errorString()).toStdString().c_str()
+            );
+            return false;
+        }
+    }
+    stdLogger.Debug(QString("Serving queries on %1").arg(serverName()).toStdString().c_str());
+    return true;
+}
+
+void QueryService::close() {
+    if (server != nullptr) server->close();
+    foreach (const Client& client, clients) client.socket->abort();
+}
+
+bool QueryService::isListening() const {
+    return server != nullptr && server->isListening();
+}
+
+void QueryService::on_new_connection() {
+    while (QLocalSocket* socket = server->nextPendingConnection()) {
+        quint64 id = nextClient++;
+        Client client;
+        client.socket = socket;
+        client.nextBatch = client.nextReply = 0;
+        clients.insert(id, client);
+
+        socket->setProperty("clientId", id);
+        /* Stops taking data from the client once a few requests are pending. */
+        socket->setReadBufferSize(2 * maxRequestFrame);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(on_client_ready()));
+        connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(on_client_ready()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(on_client_disconnected()));
+        dispatch(id);
+    }
+}
+
+void QueryService::on_client_ready() {
+    dispatch(sender()->property("clientId").toULongLong());
+}
+
+void QueryService::on_client_disconnected() {
+    QObject* socket = sender();
+    clients.remove(socket->property("clientId").toULongLong());
+    socket->deleteLater();
+}
+
+void QueryService::dispatch(quint64 id) {
+    QHash<quint64, Client>::iterator iter = clients.find(id);
+    if (iter == clients.end()) return;
+    Client& client = iter.value();
+
+    QByteArray payload;
+    QVector<ServiceQuery> batch;
+    while (client.nextBatch - client.nextReply < quint64(maxClientBatches)
+           && client.socket->bytesToWrite() < maxClientBacklog) {
+        int res = QueryProtocol::takeFrame(client.socket, payload, maxRequestFrame);
+        if (res == 0) break;
+        if (res < 0 || !QueryProtocol::decodeRequest(payload, batch)) {
+            stdLogger.Warning("Malformed request: query client dropped.");
+            client.socket->abort();
+            return;
+        }
+
+        quint64 seq = client.nextBatch++;
+        /* Loads the packs here: only the engines are used by the pool. */
+        QVector<const SearchEngine*> engines = packs->enabledEngines();
+        QtConcurrent::run(&pool, [this, id, seq, engines, batch]() {
+            QByteArray reply = runBatch(engines, batch);
+            QMetaObject::invokeMethod(
+                this, [this, id, seq, reply]() { finishBatch(id, seq, reply); },
+                Qt::QueuedConnection
+            );
+        });
+    }
+}
+
+void QueryService::finishBatch(quint64 id, quint64 seq, const QByteArray& reply) {
+    QHash<quint64, Client>::iterator iter = clients.find(id);
+    if (iter == clients.end()) return;
+    Client& client = iter.value();
+
+    client.done.insert(seq, reply);
+    /* Replies are sent in the order of the requests. */
+    while (!client.done.isEmpty() && client.done.firstKey() == client.nextReply) {
+        client.socket->write(client.done.take(client.nextReply));
+        ++client.nextReply;
+    }
+    /* Room for the requests held back. */
+    dispatch(id);
+}
+
+QByteArray QueryService::runBatch(
+    const QVector<const SearchEngine*>& engines, const QVector<ServiceQuery>& batch
+) {
+    QVector<ServiceReply> replies(batch.size());
+    strQueue results;
+    for (int i = 0; i < batch.size(); ++i) {
+        int maxCount = int(qMin(batch[i].maxResults, quint32(maxQueryResults)));
+        PackCursor cursor(engines, batch[i].pattern);
+        while (results.length() < maxCount && !cursor.atEnd())
+            cursor.fetch(results, maxCount - results.length());
+
+        replies[i].id = batch[i].id;
+        while (!results.isempty()) replies[i].results.append(results.deQueue());
+    }
+    return QueryProtocol::encodeReply(replies);
+}
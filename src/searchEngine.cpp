@@ -1,5 +1,12 @@
 #include <stdlib.h>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "allocStats.h"
 #include "searchEngine.h"
 
 /**
@@ -75,70 +82,538 @@ int KMPSearch(const QString &parent, const QString &substring) {
 }
 
 
-SearchEngine::SearchEngine() {
+/** @brief Number of entries scanned between two deadline checks. */
+static constexpr int deadlineCheckInterval = 256;
 
-}
+SearchCursor::SearchCursor()
+    : cacheVersion(0), replay(false), narrowed(false), filterEnd(0), passes(0), linear(false),
+      prefixBegin(0), prefixEnd(0), collatedBegin(0), collatedEnd(0), pos(0),
+      fuzzyPass(false), done(true) {}
 
-SearchEngine::~SearchEngine() {
+SearchCursor::SearchCursor(const strList& results)
+    : cacheVersion(0), recorded(results), replay(true), narrowed(false), filterEnd(0),
+      passes(0), linear(false), prefixBegin(0), prefixEnd(0), collatedBegin(0), collatedEnd(0),
+      pos(0), fuzzyPass(false), done(false) {}
 
+SearchCursor::SearchCursor(
+    const snapshotPtr& snapshot, const QString& pattern, int passes,
+    const std::shared_ptr<QueryCache>& cache, int cacheVersion
+) : snapshot(snapshot), cache(cache), cacheVersion(cacheVersion), replay(false),
+    pat(pattern), narrowed(false), filterEnd(0), passes(passes),
+    linear(!snapshot->indexed), fuzzyPass(false), done(false) {
+    if (PatternQuery::isPattern(pattern)) {
+        query = std::make_shared<PatternQuery>(pattern);
+        if (!query->isValid()) done = true;
+    }
+    /* Unordered results of the linear scan are not worth caching, and
+       pattern queries cannot be told apart from the entries they match. */
+    if (linear || query) this->cache.reset();
+
+    const FrontCodedList& src = snapshot->srcList;
+    if (linear || query) {
+        /* Not all ordered yet (or not a literal): every pass scans all the entries. */
+        prefixBegin = pos = 0;
+        prefixEnd = src.size() + snapshot->rawList.size();
+    } else {
+        /* Entries starting with `pattern` are contiguous in the ordered list. */
+        prefixBegin = pos = src.lowerBound(pattern);
+        prefixEnd = src.prefixEnd(pattern, prefixBegin);
+    }
+    reader = FrontCodedList::Reader(&src, pos);
+    collatedBegin = prefixBegin;
+    collatedEnd = prefixEnd;
+    if (!linear && !query && prefixEnd - prefixBegin > 1) {
+        /* They are yielded in collation order. */
+        collation = snapshot->collationIndex();
+        collation->prefixRange(pattern, collatedBegin, collatedEnd);
+        pos = collatedBegin;
+    }
+
+    if (!(passes & PrefixPass)) {
+        fuzzyPass = true;
+        pos = 0;
+    }
+    if (!query) {
+        terms = pattern.simplified().split(' ');
+        if (terms.size() < 2) terms.clear();
+        if (terms.isEmpty()) matchers.append(SubstringMatcher(pattern));
+        foreach (const QString& term, terms) matchers.append(SubstringMatcher(term));
+    }
+    if (query) {
+        foreach (const QString& literal, query->requiredLiterals()) filter.add(literal);
+    } else if (!terms.isEmpty()) {
+        foreach (const QString& term, terms) filter.add(term);
+    } else {
+        filter.add(pattern);
+    }
+    /* Until the postings are built, the blocks are scanned (`skipBlocks`). */
+    if (!linear && src.size() >= postingMinEntries && (passes & FuzzyPass)) {
+        if (query) {
+            /* Only the entries holding the required literals are examined. */
+            std::shared_ptr<const NgramIndex> ngrams = snapshot->ngramIndex();
+            if (ngrams) narrowed = ngrams->candidates(query->requiredLiterals(), candidates);
+        } else if (!terms.isEmpty()) {
+            /* Only the entries holding a token of each term are examined. */
+            std::shared_ptr<const TokenIndex> tokens = snapshot->tokenIndex();
+            if (tokens) narrowed = tokens->candidates(terms, candidates);
+        }
+    }
 }
 
-bool SearchEngine::add(const QString &word) {
-    QString wordStr = word, tmpStr;
-    int wordLength = wordStr.length(), tmpLength;
-    bool flag;
-    strList::iterator iter = srcList.begin();
-    for (; iter != srcList.end(); ++iter) {
-        flag = true;
-        tmpStr = *iter;
-        tmpLength = tmpStr.length();
-        for (int j = 0; tmpStr[j].unicode() && wordStr[j].unicode(); ++j) {
-            if (tmpStr[j] < wordStr[j]) {
-                flag = false;
+int SearchCursor::fetch(strQueue& out, int maxCount, QDeadlineTimer deadline) {
+    if (done) return 0;
+
+    if (replay) {
+        int count = 0;
+        for (; pos < recorded.size() && count < maxCount; ++count)
+            out.enQueue(recorded[pos++]);
+        if (pos >= recorded.size()) {
+            done = true;
+            recorded.clear();
+        }
+        return count;
+    }
+    if (query) return fetchPattern(out, maxCount, deadline);
+
+    int size = snapshot->srcList.size() + snapshot->rawList.size();
+    int count = 0, scanned = 0;
+    while (!done && count < maxCount) {
+        if (!fuzzyPass) {
+            if (pos >= collatedEnd) {
+                if (!(passes & FuzzyPass)) {
+                    done = true;
+                    break;
+                }
+                fuzzyPass = true;
+                pos = 0;
+                continue;
+            }
+            int idx = collation ? collation->entryAt(pos) : pos;
+            ++pos;
+            /* The collation range also holds the entries differing by case or accents. */
+            if (idx < prefixBegin || idx >= prefixEnd) continue;
+            const QString& item = entryAt(idx);
+            if (!linear || item.startsWith(pat)) {
+                yield(out, item);
+                ++count;
+            }
+        } else if (narrowed) {
+            if (pos >= candidates.size()) {
+                done = true;
+                break;
+            }
+            int idx = candidates[pos++];
+            if (idx >= prefixBegin && idx < prefixEnd) continue;
+            if (containsAt(idx)) {
+                yield(out, entryAt(idx));
+                ++count;
+            }
+        } else {
+            skipBlocks();
+            if (!linear && pos >= prefixBegin && pos < prefixEnd) {
+                pos = prefixEnd;
+                continue;
+            }
+            if (pos >= size) {
+                done = true;
                 break;
-            } else if (tmpStr[j] > wordStr[j]) {
-                srcList.insert(iter, wordStr);
-                return true;
+            }
+            int idx = pos++;
+            if (containsAt(idx)) {
+                const QString& item = entryAt(idx);
+                if (!linear || !item.startsWith(pat)) {
+                    yield(out, item);
+                    ++count;
+                }
             }
         }
-        if (flag) {
-            /* find a same word. */
-            if (tmpLength == wordLength)
-                return false;
-            /* `tmpStr` starts with `wordStr`. */
-            else if (tmpLength > wordLength) {
-                srcList.insert(iter, wordStr);
-                return true;
+        if (++scanned % deadlineCheckInterval == 0 && deadline.hasExpired())
+            break;
+    }
+
+    if (cache && recorded.size() > cache->maxResults()) {
+        /* Too large to be cached. */
+        cache.reset();
+        recorded.clear();
+    }
+    if (done) {
+        if (cache) cache->insert(pat, passes, recorded, cacheVersion);
+        cache.reset();
+        recorded.clear();
+        collation.reset();
+        snapshot.reset();
+    }
+    return count;
+}
+
+int SearchCursor::fetchPattern(strQueue& out, int maxCount, QDeadlineTimer deadline) {
+    int size = snapshot->srcList.size() + snapshot->rawList.size();
+    int count = 0, scanned = 0;
+    while (!done && count < maxCount) {
+        if (!fuzzyPass) {
+            if (pos >= size) {
+                if (!(passes & FuzzyPass)) {
+                    done = true;
+                    break;
+                }
+                fuzzyPass = true;
+                pos = 0;
+                continue;
+            }
+            const QString& item = entryAt(pos);
+            if (query->matchesPrefix(item)) {
+                yield(out, item);
+                ++count;
+                ++pos;
+            } else if (!linear) {
+                /* The entries sharing a prefix the automaton cannot get past are skipped. */
+                int dead = query->deadPrefix(item);
+                pos = dead < 0 ? pos + 1 : snapshot->srcList.prefixEnd(item.left(dead), pos);
+            } else {
+                ++pos;
+            }
+        } else {
+            int idx;
+            if (narrowed) {
+                if (pos >= candidates.size()) {
+                    done = true;
+                    break;
+                }
+                idx = candidates[pos++];
+            } else {
+                skipBlocks();
+                if (pos >= size) {
+                    done = true;
+                    break;
+                }
+                idx = pos++;
+            }
+            const QString& item = entryAt(idx);
+            if (query->matches(item) && !query->matchesPrefix(item)) {
+                yield(out, item);
+                ++count;
             }
-            /* else: `wordStr` starts with `tmpStr`. */
         }
+        if (++scanned % deadlineCheckInterval == 0 && deadline.hasExpired())
+            break;
+    }
+    if (done) snapshot.reset();
+    return count;
+}
+
+bool SearchCursor::containsAt(int idx) {
+    int ordered = snapshot->srcList.size();
+    if (idx >= ordered) {
+        const QString& item = snapshot->rawList[idx - ordered];
+        foreach (const SubstringMatcher& matcher, matchers) {
+            if (!matcher.matches(item)) return false;
+        }
+        return true;
+    }
+    seekReader(idx);
+    foreach (const SubstringMatcher& matcher, matchers) {
+        if (!matcher.matches(reader)) return false;
     }
-    srcList.push_back(wordStr);
+    return true;
+}
+
+void SearchCursor::skipBlocks() {
+    if (pos >= filterEnd && pos < snapshot->srcList.size())
+        pos = snapshot->srcList.skipBlocks(filter, pos, filterEnd);
+}
+
+void SearchCursor::yield(strQueue& out, const QString& item) {
+    out.enQueue(item);
+    if (cache) recorded.append(item);
+}
+
+const QString& SearchCursor::entryAt(int idx) {
+    int ordered = snapshot->srcList.size();
+    if (idx >= ordered) return snapshot->rawList[idx - ordered];
+    seekReader(idx);
+    return reader.value();
+}
+
+void SearchCursor::seekReader(int idx) {
+    /* Scans decode the entries one after another. */
+    if (reader.index() == idx - 1) reader.next();
+    else if (reader.index() != idx) reader.seek(idx);
+}
+
+
+/**
+ * @brief Sorts entries and removes the duplicates.
+ * 
+ * @note Runs on a worker thread for bulk loads, so it only touches its own argument.
+ */
+static strList buildIndex(strList entries) {
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    return entries;
+}
+
+
+EngineSnapshot::EngineSnapshot() : indexed(false), version(0) {}
+
+EngineSnapshot::EngineSnapshot(const EngineSnapshot& other)
+    : srcList(other.srcList), rawList(other.rawList),
+      indexed(other.indexed), version(other.version) {}
+
+std::shared_ptr<const NgramIndex> EngineSnapshot::ngramIndex() const {
+    std::shared_ptr<const NgramIndex> res = std::atomic_load(&ngrams);
+    if (res || !ngramsStarted.testAndSetOrdered(0, 1)) return res;
+    /* Keeps the snapshot alive until they are built. */
+    snapshotPtr self = shared_from_this();
+    QtConcurrent::run([self]() {
+        std::shared_ptr<const NgramIndex> built(new NgramIndex(self->srcList));
+        std::atomic_store(&self->ngrams, built);
+    });
+    return res;
+}
+
+std::shared_ptr<const TokenIndex> EngineSnapshot::tokenIndex() const {
+    std::shared_ptr<const TokenIndex> res = std::atomic_load(&tokens);
+    if (res || !tokensStarted.testAndSetOrdered(0, 1)) return res;
+    snapshotPtr self = shared_from_this();
+    QtConcurrent::run([self]() {
+        std::shared_ptr<const TokenIndex> built(new TokenIndex(self->srcList));
+        std::atomic_store(&self->tokens, built);
+    });
+    return res;
+}
+
+std::shared_ptr<const CollationIndex> EngineSnapshot::collationIndex() const {
+    std::shared_ptr<const CollationIndex> res = std::atomic_load(&collation);
+    if (res) return res;
+    std::shared_ptr<const CollationIndex> built(new CollationIndex(srcList));
+    if (std::atomic_compare_exchange_strong(&collation, &res, built)) return built;
+    return res;
+}
+
+
+SearchEngine::SearchEngine() : cache(new QueryCache) {
+    EngineSnapshot* empty = new EngineSnapshot;
+    empty->indexed = true;
+    empty->version = 0;
+    current.reset(empty);
+    prefetchPool.setMaxThreadCount(1);
+}
+
+SearchEngine::~SearchEngine() {
+    cancelPrefetch();
+    prefetchPool.waitForDone();
+    building.waitForFinished();
+}
+
+void SearchEngine::publish(EngineSnapshot* next, const strList* changed) {
+    /* Invalidates both before and after the publication, so that neither
+       a lookup nor a query in flight brings back stale results. */
+    if (changed) cache->invalidate(*changed);
+    else cache->invalidateAll();
+
+    next->version = snapshot()->version + 1;
+    std::atomic_store(&current, snapshotPtr(next));
+
+    if (changed) cache->invalidate(*changed);
+    else cache->invalidateAll();
+}
+
+void SearchEngine::load(
+    const strList& entries, const std::function<void(const EngineSnapshot&)>& indexed
+) {
+    ALLOC_SCOPE("SearchEngine::load");
+    QMutexLocker locker(&writeLock);
+    building.waitForFinished();
+
+    snapshotPtr cur = snapshot();
+    EngineSnapshot* next = new EngineSnapshot;
+    /* The ordered entries are kept: only the new ones are scanned linearly. */
+    next->srcList = cur->srcList;
+    next->rawList = entries;
+    next->indexed = false;
+    publish(next, nullptr);
+
+    building = QtConcurrent::run([this, cur, entries, indexed]() {
+        ALLOC_SCOPE("SearchEngine::load (build)");
+        EngineSnapshot* built = new EngineSnapshot;
+        /* Only the new entries are sorted, then merged. */
+        built->srcList = cur->srcList.merged(buildIndex(entries), strList());
+        built->indexed = true;
+        /* The sort keys are computed here rather than on the first keystroke. */
+        built->collationIndex();
+        /* Writers are waiting for `building`: nothing else is published meanwhile. */
+        publish(built, nullptr);
+        if (indexed) indexed(*built);
+    });
+}
+
+void SearchEngine::loadIndexed(
+    const FrontCodedList& list, const std::shared_ptr<const CollationIndex>& collation
+) {
+    QMutexLocker locker(&writeLock);
+    building.waitForFinished();
+
+    EngineSnapshot* next = new EngineSnapshot;
+    next->srcList = list;
+    next->collation = collation;
+    next->indexed = true;
+    publish(next, nullptr);
+}
+
+bool SearchEngine::add(const QString &word) {
+    QMutexLocker locker(&writeLock);
+    building.waitForFinished();
+
+    snapshotPtr cur = snapshot();
+    int idx = cur->srcList.lowerBound(word);
+    /* find a same word. */
+    if (idx < cur->srcList.size() && cur->srcList.at(idx) == word) return false;
+
+    EngineSnapshot* next = new EngineSnapshot(*cur);
+    next->srcList = cur->srcList.inserted(idx, word);
+    strList changed(1, word);
+    publish(next, &changed);
     return true;
 }
 
 bool SearchEngine::del(const QString &word) {
-    strList::iterator iter = srcList.begin();
-    for (; iter != srcList.end(); ++iter) {
-        if (!(*iter).compare(word)) {
-            srcList.erase(iter);
-            return true;
+    QMutexLocker locker(&writeLock);
+    building.waitForFinished();
+
+    snapshotPtr cur = snapshot();
+    int idx = cur->srcList.lowerBound(word);
+    if (idx >= cur->srcList.size() || cur->srcList.at(idx) != word) return false;
+
+    EngineSnapshot* next = new EngineSnapshot(*cur);
+    next->srcList = cur->srcList.removed(idx);
+    strList changed(1, word);
+    publish(next, &changed);
+    return true;
+}
+
+QFuture<void> SearchEngine::update(const strList &added, const strList &removed) {
+    QMutexLocker locker(&writeLock);
+    building.waitForFinished();
+
+    snapshotPtr cur = snapshot();
+    building = QtConcurrent::run([this, cur, added, removed]() {
+        strList addList = buildIndex(added), delList = buildIndex(removed);
+        EngineSnapshot* next = new EngineSnapshot;
+        next->indexed = true;
+        /* Only the blocks holding changes are re-encoded. */
+        next->srcList = cur->srcList.merged(addList, delList);
+        /* The sort keys are computed here rather than on the next keystroke. */
+        next->collationIndex();
+        strList changed = addList + delList;
+        /* Writers are waiting for `building`: nothing else is published meanwhile. */
+        publish(next, &changed);
+    });
+    return building;
+}
+
+void SearchEngine::clear() {
+    QMutexLocker locker(&writeLock);
+    building.waitForFinished();
+
+    EngineSnapshot* next = new EngineSnapshot;
+    next->indexed = true;
+    publish(next, nullptr);
+}
+
+int SearchEngine::size() const {
+    snapshotPtr cur = snapshot();
+    return cur->srcList.size() + cur->rawList.size();
+}
+
+strQueue SearchEngine::findRelative(const QString &pattern) const {
+    /* A regular expression allocates its matches for each entry scanned: not budgeted. */
+    ALLOC_BUDGET("SearchEngine::findRelative", PatternQuery::isPattern(pattern) ? 0 : queryAllocBudget);
+    strQueue res;
+    search(pattern).fetch(res, std::numeric_limits<int>::max());
+    ALLOC_ALLOW(quint64(res.length()) * resultAllocBudget);
+    return res;
+}
+
+SearchCursor SearchEngine::search(const QString &pattern, int passes) const {
+    /* Read first: a publication in between makes the results recorded for it stale. */
+    int version = cache->version();
+    snapshotPtr cur = snapshot();
+    strList results;
+    if (cur->indexed && !PatternQuery::isPattern(pattern) && cache->lookup(pattern, passes, results))
+        return SearchCursor(results);
+    return SearchCursor(cur, pattern, passes, cache, version);
+}
+
+void SearchEngine::prefetch(const QString& pattern, const QVector<int>& passes) {
+    int generation = prefetchGeneration.fetchAndAddOrdered(1) + 1;
+    snapshotPtr cur = snapshot();
+    /* Only the literal queries on the ordered list are cached. */
+    if (!cur->indexed || PatternQuery::isPattern(pattern)) return;
+
+    QtConcurrent::run(&prefetchPool, [this, cur, pattern, passes, generation]() {
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+        foreach (QChar ch, likelyExtensions(*cur, pattern, generation)) {
+            foreach (int pass, passes) warm(pattern + ch, pass, generation);
+        }
+    });
+}
+
+void SearchEngine::cancelPrefetch() {
+    prefetchGeneration.fetchAndAddOrdered(1);
+}
+
+QVector<QChar> SearchEngine::likelyExtensions(
+    const EngineSnapshot& snapshot, const QString& pattern, int generation
+) const {
+    const FrontCodedList& src = snapshot.srcList;
+    int len = pattern.size(), scanned = 0;
+    int begin = src.lowerBound(pattern), end = src.prefixEnd(pattern, begin);
+    QVector<ushort> next;
+    /* Characters typed next in the key. */
+    auto sample = [&next, len](const QString& entry) {
+        if (entry.size() > len && entry[len] != QChar(pairDelim) && !entry[len].isSurrogate())
+            next.append(entry[len].unicode());
+    };
+    if (end - begin <= prefetchSamples) {
+        for (FrontCodedList::Reader reader(&src, begin); reader.index() < end; reader.next()) {
+            if (++scanned % deadlineCheckInterval == 0 && prefetchCancelled(generation))
+                return QVector<QChar>();
+            sample(reader.value());
         }
+    } else {
+        /* Evenly spaced entries keep the frequencies of a short prefix, for a bounded cost. */
+        for (int i = 0; i < prefetchSamples; ++i) {
+            if (++scanned % deadlineCheckInterval == 0 && prefetchCancelled(generation))
+                return QVector<QChar>();
+            sample(src.at(begin + int(qint64(end - begin) * i / prefetchSamples)));
+        }
+    }
+
+    /* Counts the children of the prefix (negated: the most frequent first). */
+    std::sort(next.begin(), next.end());
+    QVector<std::pair<int, ushort>> children;
+    for (int i = 0, j; i < next.size(); i = j) {
+        for (j = i + 1; j < next.size() && next[j] == next[i]; ++j) {}
+        children.append(std::make_pair(i - j, next[i]));
     }
-    return false;
+    std::sort(children.begin(), children.end());
+    QVector<QChar> res;
+    for (int i = 0; i < children.size() && i < prefetchBranches; ++i)
+        res.append(QChar(children[i].second));
+    return res;
 }
 
-strQueue SearchEngine::findRelative(const QString &pattern) {
-    strQueue startsWithMatch, fuzzyMatch;
-    
-    for (QString item : srcList) {
-        
-        if (item.startsWith(pattern))
-            startsWithMatch.enQueue(item);
-        else if (KMPSearch(item, pattern) != -1)
-            fuzzyMatch.enQueue(item);
+void SearchEngine::warm(const QString& pattern, int passes, int generation) const {
+    if (prefetchCancelled(generation) || PatternQuery::isPattern(pattern)) return;
+    /* Not through `search`: warming is neither a hit nor a miss of the cache statistics. */
+    int version = cache->version();
+    snapshotPtr cur = snapshot();
+    if (cache->contains(pattern, passes)) return;
+    SearchCursor cursor(cur, pattern, passes, cache, version);
+    strQueue sink;
+    /* Stops when cached already, or too large to be cached. */
+    while (!cursor.atEnd() && cursor.cache && !prefetchCancelled(generation)) {
+        cursor.fetch(sink, fillChunk, QDeadlineTimer(frameBudget));
+        sink.clear();
     }
-    while (!fuzzyMatch.isempty())
-        startsWithMatch.enQueue(fuzzyMatch.deQueue());
-    return startsWithMatch;
 }
@@ -0,0 +1,182 @@
+#include <string.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+
+#include "sharedIndex.h"
+
+/** @brief The sections of an index file, in order. */
+enum IndexSection {
+    UnitsSection, BlockOffsetSection, BlockStartSection, BlockLatin1Section,
+    BlockFilterSection, KeysSection, KeyOffsetSection, OrderSection,
+    SectionCount
+};
+
+/** @brief The header of an index file (in the byte order of the machine). */
+struct IndexHeader {
+    quint32 magic;
+    quint32 format;
+    /** @brief The version of the dictionary. */
+    qint64  sourceSize;
+    qint64  sourceModified;
+    qint32  count;
+    qint32  blocks;
+    qint32  units;
+    qint32  keyBytes;
+    qint32  filterBits;
+    qint32  reserved;
+    /** @brief The position of each section in the file. */
+    qint64  offset[SectionCount];
+};
+
+/* "ESIX", which also tells the byte order apart. */
+static const quint32 indexMagic = 0x58495345;
+static const quint32 indexFormat = 1;
+/* Sections start at multiples of it, enough for any of their arrays. */
+static const qint64 sectionAlign = 8;
+
+static qint64 aligned(qint64 pos) {
+    return (pos + sectionAlign - 1) / sectionAlign * sectionAlign;
+}
+
+static void sectionSizes(const IndexHeader& header, qint64 sizes[SectionCount]) {
+    sizes[UnitsSection] = qint64(header.units) * sizeof(ushort);
+    sizes[BlockOffsetSection] = (qint64(header.blocks) + 1) * sizeof(int);
+    sizes[BlockStartSection] = qint64(header.blocks) * sizeof(int);
+    sizes[BlockLatin1Section] = header.blocks;
+    sizes[BlockFilterSection] = qint64(header.blocks) * sizeof(GramFilter);
+    sizes[KeysSection] = header.keyBytes;
+    sizes[KeyOffsetSection] = (qint64(header.count) + 1) * sizeof(int);
+    sizes[OrderSection] = qint64(header.count) * sizeof(int);
+}
+
+/** @brief Check if `values` never decrease (nor stay the same if `strict`). */
+static bool isAscending(const int* values, int len, bool strict) {
+    for (int i = 1; i < len; ++i) {
+        if (values[i] < values[i - 1] + (strict ? 1 : 0)) return false;
+    }
+    return true;
+}
+
+QString SharedIndex::indexPath(const QString& dictionary) {
+    QFileInfo info(dictionary);
+    return info.absolutePath() + "/" + sharedIndexDir + "/" + info.fileName() + ".idx";
+}
+
+SharedIndex::Version SharedIndex::versionOf(const QString& dictionary) {
+    QFileInfo info(dictionary);
+    Version res;
+    res.size = info.size();
+    res.modified = info.lastModified().toMSecsSinceEpoch();
+    return res;
+}
+
+bool SharedIndex::attach(
+    const QString& path, const Version& source,
+    FrontCodedList& list, std::shared_ptr<const CollationIndex>& collation
+) {
+    std::shared_ptr<QFile> file = std::make_shared<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly) || file->size() < qint64(sizeof(IndexHeader)))
+        return false;
+    const uchar* data = file->map(0, file->size());
+    if (data == nullptr) return false;
+
+    IndexHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != indexMagic || header.format != indexFormat
+        || header.filterBits != gramFilterBits
+        || header.sourceSize != source.size || header.sourceModified != source.modified)
+        return false;
+    if (header.count < 0 || header.blocks < 0 || header.units < 0 || header.keyBytes < 0)
+        return false;
+    qint64 sizes[SectionCount];
+    sectionSizes(header, sizes);
+    for (int i = 0; i < SectionCount; ++i) {
+        if (header.offset[i] % sectionAlign != 0 || header.offset[i] < qint64(sizeof(header))
+            || header.offset[i] > file->size() - sizes[i])
+            return false;
+    }
+
+    const ushort* units = reinterpret_cast<const ushort*>(data + header.offset[UnitsSection]);
+    const int* blockOffset = reinterpret_cast<const int*>(data + header.offset[BlockOffsetSection]);
+    const int* blockStart = reinterpret_cast<const int*>(data + header.offset[BlockStartSection]);
+    const quint8* blockLatin1 = data + header.offset[BlockLatin1Section];
+    const GramFilter* blockFilter =
+        reinterpret_cast<const GramFilter*>(data + header.offset[BlockFilterSection]);
+    const char* keys = reinterpret_cast<const char*>(data + header.offset[KeysSection]);
+    const int* keyOffset = reinterpret_cast<const int*>(data + header.offset[KeyOffsetSection]);
+    const int* order = reinterpret_cast<const int*>(data + header.offset[OrderSection]);
+
+    /* The arrays must stay in bounds of one another. */
+    if ((header.blocks == 0) != (header.count == 0)
+        || blockOffset[0] != 0 || blockOffset[header.blocks] != header.units
+        || !isAscending(blockOffset, header.blocks + 1, false)
+        || (header.blocks && (blockStart[0] != 0 || blockStart[header.blocks - 1] >= header.count))
+        || !isAscending(blockStart, header.blocks, true)
+        || keyOffset[0] != 0 || keyOffset[header.count] != header.keyBytes
+        || !isAscending(keyOffset, header.count + 1, false))
+        return false;
+    /* The collation order is a permutation of the entries. */
+    QVector<bool> seen(header.count, false);
+    for (int i = 0; i < header.count; ++i) {
+        if (order[i] < 0 || order[i] >= header.count || seen[order[i]]) return false;
+        seen[order[i]] = true;
+    }
+
+    /* The mapping lives as long as the lists reading it. */
+    FrontCodedList mapped(
+        file, units, blockOffset, blockStart, blockLatin1, blockFilter,
+        header.blocks, header.count
+    );
+    /* Readers follow the lengths stored in the units: each one is checked once here. */
+    if (!mapped.isWellFormed()) return false;
+    list = mapped;
+    collation.reset(new CollationIndex(file, keys, keyOffset, order, header.count));
+    return true;
+}
+
+bool SharedIndex::publish(
+    const QString& path, const Version& source,
+    const FrontCodedList& list, const CollationIndex& collation
+) {
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = indexMagic;
+    header.format = indexFormat;
+    header.sourceSize = source.size;
+    header.sourceModified = source.modified;
+    header.count = list.count;
+    header.blocks = list.blocks;
+    header.units = list.blockOffset[list.blocks];
+    header.keyBytes = collation.keyOffset[collation.count];
+    header.filterBits = gramFilterBits;
+
+    const void* arrays[SectionCount] = {
+        list.units, list.blockOffset, list.blockStart, list.blockLatin1,
+        list.blockFilter, collation.keys, collation.keyOffset, collation.order
+    };
+    qint64 sizes[SectionCount];
+    sectionSizes(header, sizes);
+    qint64 pos = aligned(sizeof(header));
+    for (int i = 0; i < SectionCount; ++i) {
+        header.offset[i] = pos;
+        pos = aligned(pos + sizes[i]);
+    }
+
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) return false;
+    /* Written aside, then renamed over the previous version. */
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    static const char padding[sectionAlign] = {0};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pos = sizeof(header);
+    for (int i = 0; i < SectionCount; ++i) {
+        file.write(padding, header.offset[i] - pos);
+        file.write(static_cast<const char*>(arrays[i]), sizes[i]);
+        pos = header.offset[i] + sizes[i];
+    }
+    return file.commit();
+}
@@ -0,0 +1,60 @@
+#include <string.h>
+
+#include "substringMatcher.h"
+
+/** @brief Finds `needle` by scanning for its first unit, then comparing the rest. */
+template <typename Unit>
+static bool containsUnits(const Unit* text, int len, const Unit* needle, int nlen) {
+    if (nlen == 0) return true;
+    for (const Unit* last = text + len - nlen; text <= last; ++text) {
+        if (*text == *needle && memcmp(text + 1, needle + 1, (nlen - 1) * sizeof(Unit)) == 0)
+            return true;
+    }
+    return false;
+}
+
+/** @brief Bytes are scanned with `memchr` (vectorized by the C library). */
+template <>
+bool containsUnits<char>(const char* text, int len, const char* needle, int nlen) {
+    if (nlen == 0) return true;
+    while (len >= nlen) {
+        const char* hit = static_cast<const char*>(memchr(text, *needle, len - nlen + 1));
+        if (hit == nullptr) return false;
+        if (memcmp(hit + 1, needle + 1, nlen - 1) == 0) return true;
+        len -= hit + 1 - text;
+        text = hit + 1;
+    }
+    return false;
+}
+
+static bool containsUnits(const QString& text, const QString& needle) {
+    return containsUnits(
+        reinterpret_cast<const ushort*>(text.constData()), text.size(),
+        reinterpret_cast<const ushort*>(needle.constData()), needle.size()
+    );
+}
+
+
+SubstringMatcher::SubstringMatcher() : latin1(true), spansKey(false) {}
+
+SubstringMatcher::SubstringMatcher(const QString& needle)
+    : needle(needle), latin1(true), spansKey(needle.contains(QChar(pairDelim))) {
+    needle8.reserve(needle.size());
+    for (int i = 0; i < needle.size() && latin1; ++i) {
+        latin1 = needle[i].unicode() <= 0xff;
+        needle8.append(char(needle[i].unicode()));
+    }
+}
+
+bool SubstringMatcher::matches(const QString& text) const {
+    return containsUnits(text, needle);
+}
+
+bool SubstringMatcher::matches(const FrontCodedList::Reader& reader) const {
+    /* A match within the key or the tail cannot hold the `pairDelim` between them. */
+    if (spansKey) return matches(reader.value());
+    if (containsUnits(reader.tail(), needle)) return true;
+    if (!reader.isLatin1()) return containsUnits(reader.wideKey(), needle);
+    const QByteArray& key = reader.latin1Key();
+    return latin1 && containsUnits(key.constData(), key.size(), needle8.constData(), needle8.size());
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+
+#include <QtCore/QHash>
+
+#include "tokenIndex.h"
+
+TokenIndex::TokenIndex(const FrontCodedList& list) {
+    QHash<QString, int> ids;
+    for (FrontCodedList::Reader reader(&list, 0); !reader.atEnd(); reader.next()) {
+        const QString& entry = reader.value();
+        int begin = 0;
+        while (begin < entry.length()) {
+            int end = begin;
+            while (end < entry.length() && !entry[end].isSpace()) ++end;
+            if (end > begin) {
+                QString token = entry.mid(begin, end - begin);
+                int id = ids.value(token, -1);
+                if (id < 0) {
+                    id = tokens.length();
+                    ids.insert(token, id);
+                    tokens.append(token);
+                    postings.append(postingList());
+                }
+                postingList& posting = postings[id];
+                /* Once per entry. */
+                if (posting.isEmpty() || posting.last() != reader.index())
+                    posting.append(reader.index());
+            }
+            begin = end + 1;
+        }
+    }
+    for (postingList& posting : postings) posting.squeeze();
+}
+
+bool TokenIndex::candidates(const QStringList& terms, postingList& candidates) const {
+    struct Term {
+        QVector<const postingList*> lists;
+        /** @brief Upper bound of the entries containing the term. */
+        qint64 size;
+    };
+    QVector<Term> resolved;
+    foreach (const QString& term, terms) {
+        Term cur;
+        cur.size = 0;
+        for (int i = 0; i < tokens.length() && cur.lists.size() <= maxUnionProbes; ++i) {
+            if (tokens[i].contains(term)) {
+                cur.lists.append(&postings[i]);
+                cur.size += postings[i].size();
+            }
+        }
+        /* Too many tokens: uniting them costs more than checking the entries. */
+        if (cur.lists.size() <= maxUnionProbes) resolved.append(cur);
+    }
+    if (resolved.isEmpty()) return false;
+
+    /* Smallest first: the candidates only shrink from there. */
+    std::sort(resolved.begin(), resolved.end(), [](const Term& a, const Term& b) {
+        return a.size < b.size;
+    });
+    candidates = unitePostings(resolved[0].lists);
+    for (int i = 1; i < resolved.size() && !candidates.isEmpty(); ++i) {
+        if (resolved[i].lists.size() == 1)
+            intersectPostings(candidates, *resolved[i].lists[0]);
+        else
+            intersectUnion(candidates, resolved[i].lists);
+    }
+    return true;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file   containers.cpp
+ * @brief  Differential test & benchmark of the containers of `utils.h`.
+ * 
+ * Without argument, runs random operations on the containers and on their
+ * `std::` counterparts, and fails at the first difference. With `--bench`,
+ * measures their throughput and the copy of a mostly empty container.
+ * 
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <random>
+#include <stack>
+#include <vector>
+
+#include <QtCore/QString>
+
+#include "utils.h"
+
+/* Reports a failed check (`assert` is disabled in release builds). */
+#define check(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+/** @brief Operations of each differential run. */
+static const int testOps = 200000;
+/** @brief Elements pushed by each benchmark. */
+static const int benchElems = 1000000;
+
+/** @brief Builds a random element (short & long strings). */
+static QString randomElem(std::mt19937& rng) {
+    return QString::number(int(rng() % 1000)) + QString(int(rng() % 30), QChar('x'));
+}
+
+/** @brief Runs random operations on every container with `inlineSize` inline slots. */
+template <int inlineSize>
+static void differential(unsigned seed) {
+    std::mt19937 rng(seed);
+    seqStack<QString, inlineSize> stack;
+    std::vector<QString> stackRef;
+    seqDeque<QString, inlineSize> deque;
+    std::deque<QString> dequeRef;
+    priorityQueue<QString, greater, inlineSize> heap;
+    std::priority_queue<QString> heapRef;
+
+    for (int op = 0; op < testOps; ++op) {
+        QString elem = randomElem(rng);
+        switch (rng() % 12) {
+        case 0: case 1:
+            stack.push(elem);
+            stackRef.push_back(elem);
+            break;
+        case 2:
+            if (stackRef.empty()) {
+                bool thrown = false;
+                try { stack.pop(); } catch (const ContainerNoElement&) { thrown = true; }
+                check(thrown);
+            } else {
+                check(stack.pop() == stackRef.back());
+                stackRef.pop_back();
+            }
+            break;
+        case 3:
+            deque.enQueue(elem);
+            dequeRef.push_back(elem);
+            break;
+        case 4:
+            deque.prepend(elem);
+            dequeRef.push_front(elem);
+            break;
+        case 5:
+            if (!dequeRef.empty()) {
+                check(deque.deQueue() == dequeRef.front());
+                dequeRef.pop_front();
+            }
+            break;
+        case 6:
+            if (!dequeRef.empty()) {
+                check(deque.pop_back() == dequeRef.back());
+                dequeRef.pop_back();
+            }
+            break;
+        case 7:
+            heap.enQueue(elem);
+            heapRef.push(elem);
+            break;
+        case 8:
+            if (!heapRef.empty()) {
+                check(heap.deQueue() == heapRef.top());
+                heapRef.pop();
+            }
+            break;
+        case 9:
+            /* Pushes an element of the container itself (may reallocate). */
+            if (!dequeRef.empty()) {
+                deque.enQueue(deque.getHead());
+                dequeRef.push_back(dequeRef.front());
+            }
+            break;
+        case 10: {
+            seqDeque<QString, inlineSize> copied = deque;
+            seqDeque<QString, inlineSize> moved = std::move(copied);
+            check(copied.isempty());
+            copied.enQueue("z");
+            size_t i = 0;
+            for (const QString& e : moved) check(i < dequeRef.size() && e == dequeRef[i++]);
+            check(i == dequeRef.size());
+
+            seqStack<QString, inlineSize> stackCopy = stack;
+            stackCopy = std::move(stack);
+            stack = stackCopy;
+            priorityQueue<QString, greater, inlineSize> heapCopy = heap;
+            heap = heapCopy;
+            heap = std::move(heapCopy);
+            check(heapCopy.empty());
+            break;
+        }
+        case 11:
+            if (rng() % 50 == 0) {
+                deque.clear();
+                dequeRef.clear();
+                stack.clear();
+                stackRef.clear();
+            }
+            break;
+        }
+        check(deque.length() == int(dequeRef.size()));
+        check(stack.size() == int(stackRef.size()));
+        check(heap.size() == int(heapRef.size()));
+        if (!dequeRef.empty()) {
+            check(deque.getHead() == dequeRef.front());
+            check(deque.getTail() == dequeRef.back());
+        }
+        if (!stackRef.empty()) check(stack.top() == stackRef.back());
+    }
+    size_t i = 0;
+    for (const QString& e : stack) check(e == stackRef[i++]);
+
+    QString init[5] = {"e", "b", "c", "a", "d"};
+    priorityQueue<QString> built(init, 5);
+    check(built.deQueue() == "e");
+    printf("differential (inline %d): ok\n", inlineSize);
+}
+
+typedef std::chrono::steady_clock benchClock;
+
+/** @brief Gets the milliseconds elapsed since `start`. */
+static double elapsed(benchClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(benchClock::now() - start).count();
+}
+
+/** @brief Measures push & drain of `benchElems` elements, and the copy of a drained queue. */
+static void benchmark() {
+    std::vector<QString> src;
+    src.reserve(benchElems);
+    for (int i = 0; i < benchElems; ++i)
+        src.push_back(QString(40, QChar('a' + i % 26)) + QString::number(i));
+
+    benchClock::time_point start = benchClock::now();
+    { seqQueue<QString> q; for (const QString& e : src) q.enQueue(e); while (!q.isempty()) q.deQueue(); }
+    double queue = elapsed(start);
+    start = benchClock::now();
+    { std::queue<QString> q; for (const QString& e : src) q.push(e); while (!q.empty()) q.pop(); }
+    double queueRef = elapsed(start);
+
+    start = benchClock::now();
+    { seqStack<QString> s; for (const QString& e : src) s.push(e); while (!s.isempty()) s.pop(); }
+    double stack = elapsed(start);
+    start = benchClock::now();
+    { std::stack<QString, std::vector<QString>> s; for (const QString& e : src) s.push(e); while (!s.empty()) s.pop(); }
+    double stackRef = elapsed(start);
+
+    start = benchClock::now();
+    {
+        seqDeque<QString> d;
+        for (int i = 0; i < benchElems; ++i) {
+            if (i & 1) d.prepend(src[i]);
+            else d.enQueue(src[i]);
+        }
+        while (!d.isempty()) d.pop_back();
+    }
+    double deque = elapsed(start);
+    start = benchClock::now();
+    {
+        std::deque<QString> d;
+        for (int i = 0; i < benchElems; ++i) {
+            if (i & 1) d.push_front(src[i]);
+            else d.push_back(src[i]);
+        }
+        while (!d.empty()) d.pop_back();
+    }
+    double dequeRef = elapsed(start);
+
+    start = benchClock::now();
+    { priorityQueue<QString> h; for (const QString& e : src) h.enQueue(e); while (!h.empty()) h.deQueue(); }
+    double heap = elapsed(start);
+    start = benchClock::now();
+    { std::priority_queue<QString> h; for (const QString& e : src) h.push(e); while (!h.empty()) h.pop(); }
+    double heapRef = elapsed(start);
+
+    /* Only the live elements of a copied container are copied. */
+    seqQueue<QString> drained;
+    for (const QString& e : src) drained.enQueue(e);
+    while (drained.length() > 10) drained.deQueue();
+    const int copies = 100;
+    start = benchClock::now();
+    for (int i = 0; i < copies; ++i) { seqQueue<QString> copied(drained); }
+    double copy = elapsed(start) / copies;
+
+    printf("push & drain of %d QString, in ms (seq* / std::)\n", benchElems);
+    printf("  queue %8.1f / %8.1f\n", queue, queueRef);
+    printf("  stack %8.1f / %8.1f\n", stack, stackRef);
+    printf("  deque %8.1f / %8.1f\n", deque, dequeRef);
+    printf("  heap  %8.1f / %8.1f\n", heap, heapRef);
+    printf("copy of a queue with 10 live elements (1M capacity): %.4f ms\n", copy);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        benchmark();
+        return 0;
+    }
+    differential<0>(1);
+    differential<4>(2);
+    differential<16>(3);
+
+    /* A container may start with no slot. */
+    seqStack<int> stack(0);
+    stack.push(1);
+    check(stack.pop() == 1);
+    seqQueue<int> queue(0);
+    queue.enQueue(3);
+    check(queue.deQueue() == 3);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file   patternQuery.cpp
+ * @brief  Test of the literals required by the patterns (see `PatternQuery`).
+ *
+ * Every literal must be contained in every match: the fuzzy pass only
+ * scans the entries holding them.
+ *
+ * @author SJTU-XHW
+ * @date   Oct 19, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "patternQuery.h"
+
+/* Reports a failed check (`assert` is disabled in release builds). */
+#define check(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+/** @brief A pattern, an entry it matches (if valid) & the literals expected. */
+struct LiteralCase {
+    const char* pattern;
+    const char* match;
+    QStringList literals;
+};
+
+int main() {
+    const LiteralCase cases[] = {
+        {"arrow*left", "arrow to the left", {"arrow", "left"}},
+        {"a?row", "arrow", {"a", "row"}},
+        {"/^heart.*", "heart suit", {"heart"}},
+        {"/circle\\d", "circle1", {"circle"}},
+        {"/a\\.b", "a.b", {"a.b"}},
+        {"/ab+c", "abbc", {"ab", "c"}},
+        {"/colou?r", "color", {"colo", "r"}},
+        {"/(up|down)arrow", "downarrow", {}},
+        {"/(?i)HEART", "heart", {}},
+        /* The escapes spanning more characters are not parsed. */
+        {"/a\\x41b", "aAb", {}},
+        {"/\\x{e9}t", "\xc3\xa9t", {}},
+        /* Not supported by PCRE, still never read as a literal. */
+        {"/caf\\u00e9", nullptr, {}},
+        {"/\\012x", "\nx", {}},
+        {"/\\cAx", "\x01x", {}},
+        {"/(a)\\g{1}x", "aax", {}},
+        {"/(?<n>a)\\k<n>x", "aax", {}},
+        {"/\\p{L}x", "ax", {}},
+        {"/\\Qa.b\\Ec", "a.bc", {}},
+        /* A leading `]` is a member of the class. */
+        {"/[]a]x", "]x", {"x"}},
+        {"/[^]a]x", "bx", {"x"}},
+        {"/[[:alpha:]]x", "bx", {"x"}},
+        {"/([)]a)b", ")ab", {"b"}},
+    };
+    for (const LiteralCase& c : cases) {
+        PatternQuery query(QString::fromUtf8(c.pattern));
+        if (query.requiredLiterals() != c.literals) {
+            fprintf(
+                stderr, "%s: got \"%s\"\n", c.pattern,
+                query.requiredLiterals().join("\", \"").toUtf8().constData()
+            );
+            exit(1);
+        }
+        if (!c.match) continue;
+        QString match = QString::fromUtf8(c.match);
+        check(query.isValid());
+        check(query.matches(match));
+        for (const QString& literal : query.requiredLiterals()) check(match.contains(literal));
+    }
+    printf("pattern literals: ok\n");
+    return 0;
+}